@@ -15,8 +15,8 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
   EventLoop eventloop {};
   FileDescriptor input { STDIN_FILENO };
   FileDescriptor output { STDOUT_FILENO };
-  ByteStream outbound { buffer_size };
-  ByteStream inbound { buffer_size };
+  ByteStream outbound { buffer_size, ByteStream::Storage::Ring };
+  ByteStream inbound { buffer_size, ByteStream::Storage::Ring };
   bool outbound_shutdown { false };
   bool inbound_shutdown { false };
 
@@ -30,10 +30,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     input,
     Direction::In,
     [&] {
-      string data;
-      data.resize( outbound.writer().available_capacity() );
-      input.read( data );
-      outbound.writer().push( move( data ) );
+      read_into( input, outbound.writer() );
       if ( input.eof() ) {
         outbound.writer().close();
       }
@@ -56,7 +53,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     Direction::Out,
     [&] {
       if ( outbound.reader().bytes_buffered() ) {
-        outbound.reader().pop( socket.write( outbound.reader().peek() ) );
+        outbound.reader().pop( socket.write( outbound.reader().peek_regions() ) );
       }
       if ( outbound.reader().is_finished() ) {
         socket.shutdown( SHUT_WR );
@@ -80,10 +77,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     socket,
     Direction::In,
     [&] {
-      string data;
-      data.resize( inbound.writer().available_capacity() );
-      socket.read( data );
-      inbound.writer().push( move( data ) );
+      read_into( socket, inbound.writer() );
       if ( socket.eof() ) {
         inbound.writer().close();
       }
@@ -106,7 +100,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     Direction::Out,
     [&] {
       if ( inbound.reader().bytes_buffered() ) {
-        inbound.reader().pop( output.write( inbound.reader().peek() ) );
+        inbound.reader().pop( output.write( inbound.reader().peek_regions() ) );
       }
       if ( inbound.reader().is_finished() ) {
         output.close();
@@ -16,6 +16,7 @@ using namespace std;
 
 constexpr const char* TUN_DFLT = "tun144";
 constexpr const char* LOCAL_ADDRESS_DFLT = "169.254.144.9";
+constexpr long MIN_IPV4_MTU = 68; // RFC 791: every IPv4 link must carry a 68-byte datagram
 
 namespace {
 void show_usage( const char* argv0, const char* msg )
@@ -35,6 +36,34 @@ void show_usage( const char* argv0, const char* msg )
 
        << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n\n"
 
+       << "   -C <algo>       Congestion control: none, reno, newreno,        none\n"
+       << "                   cubic, bbr\n\n"
+
+       << "   -A              Adaptive RTO from measured RTTs (RFC 6298)      (fixed RTO)\n\n"
+
+       << "   -S              Negotiate selective acknowledgments (RFC 2018)  (no SACK)\n\n"
+
+       << "   -W              Negotiate window scaling (RFC 7323)             (64 KiB windows)\n\n"
+
+       << "   -T              Negotiate timestamps (RFC 7323): RTT samples    (no timestamps)\n"
+       << "                   on retransmissions, PAWS\n\n"
+
+       << "   -N              Nagle's algorithm: coalesce small writes        (send at once)\n\n"
+
+       << "   -D              Delayed acks: ack every second segment          (ack every segment)\n\n"
+
+       << "   -R              Autotune the receive buffer, growing from       (fixed)\n"
+       << "                   <winsz> as the application drains it\n\n"
+
+       << "   -B              Autosize the send buffer to the window          (" << TCPConfig::DEFAULT_CAPACITY
+       << " bytes)\n\n"
+
+       << "   -m <mtu>        Link MTU: advertise an MSS that fits in it      (" << TCPConfig::MAX_PAYLOAD_SIZE
+       << "-byte segments)\n\n"
+
+       << "   -G <segs>       Send super-segments of up to <segs> MSS,        1\n"
+       << "                   split to the MTU by the adapter (needs -m)\n\n"
+
        << "   -d <tundev>     Connect to tun <tundev>                         " << TUN_DFLT << "\n\n"
 
        << "   -Lu <loss>      Set uplink loss to <rate> (float in 0..1)       (no loss)\n"
@@ -96,6 +125,72 @@ tuple<TCPConfig, FdAdapterConfig, bool, const char*> get_config( const span<char
       c_fsm.rt_timeout = strtol( args[curr + 1], nullptr, 0 );
       curr += 2;
 
+    } else if ( strncmp( "-A", args[curr], 3 ) == 0 ) {
+      c_fsm.adaptive_rto = true;
+      curr += 1;
+
+    } else if ( strncmp( "-S", args[curr], 3 ) == 0 ) {
+      c_fsm.sack = true;
+      curr += 1;
+
+    } else if ( strncmp( "-W", args[curr], 3 ) == 0 ) {
+      c_fsm.window_scaling = true;
+      curr += 1;
+
+    } else if ( strncmp( "-T", args[curr], 3 ) == 0 ) {
+      c_fsm.timestamps = true;
+      curr += 1;
+
+    } else if ( strncmp( "-N", args[curr], 3 ) == 0 ) {
+      c_fsm.nagle = true;
+      curr += 1;
+
+    } else if ( strncmp( "-D", args[curr], 3 ) == 0 ) {
+      c_fsm.delayed_ack = true;
+      curr += 1;
+
+    } else if ( strncmp( "-R", args[curr], 3 ) == 0 ) {
+      c_fsm.recv_autotune = true;
+      curr += 1;
+
+    } else if ( strncmp( "-B", args[curr], 3 ) == 0 ) {
+      c_fsm.send_autotune = true;
+      curr += 1;
+
+    } else if ( strncmp( "-m", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -m requires one argument." );
+      const long mtu = strtol( args[curr + 1], nullptr, 0 );
+      if ( mtu < MIN_IPV4_MTU or mtu > UINT16_MAX ) {
+        show_usage( args[0], "ERROR: -m needs an MTU between 68 and 65535." );
+        exit( 1 );
+      }
+      c_filt.mtu = static_cast<uint16_t>( mtu );
+      curr += 2;
+
+    } else if ( strncmp( "-G", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -G requires one argument." );
+      c_filt.gso_segments = static_cast<uint16_t>( strtol( args[curr + 1], nullptr, 0 ) );
+      curr += 2;
+
+    } else if ( strncmp( "-C", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -C requires one argument." );
+      const string_view algo = args[curr + 1];
+      if ( algo == "none" ) {
+        c_fsm.congestion = TCPConfig::Congestion::None;
+      } else if ( algo == "reno" ) {
+        c_fsm.congestion = TCPConfig::Congestion::Reno;
+      } else if ( algo == "newreno" ) {
+        c_fsm.congestion = TCPConfig::Congestion::NewReno;
+      } else if ( algo == "cubic" ) {
+        c_fsm.congestion = TCPConfig::Congestion::Cubic;
+      } else if ( algo == "bbr" ) {
+        c_fsm.congestion = TCPConfig::Congestion::BBR;
+      } else {
+        show_usage( args[0], "ERROR: unknown congestion control algorithm." );
+        exit( 1 );
+      }
+      curr += 2;
+
     } else if ( strncmp( "-d", args[curr], 3 ) == 0 ) {
       check_argc( args, curr, "ERROR: -t requires one argument." );
       tundev = args[curr + 1];
@@ -23,6 +23,9 @@ ttest(byte_stream_one_write)
 ttest(byte_stream_two_writes)
 ttest(byte_stream_many_writes)
 ttest(byte_stream_stress_test)
+ttest(spsc_byte_stream_stress_test)
+ttest(byte_stream_ring)
+ttest(byte_stream_chunked)
 
 ttest(reassembler_single)
 ttest(reassembler_cap)
@@ -31,12 +34,14 @@ ttest(reassembler_dup)
 ttest(reassembler_holes)
 ttest(reassembler_overlapping)
 ttest(reassembler_win)
+ttest(reassembler_interval)
 
 ttest(wrapping_integers_cmp)
 ttest(wrapping_integers_wrap)
 ttest(wrapping_integers_unwrap)
 ttest(wrapping_integers_roundtrip)
 ttest(wrapping_integers_extra)
+ttest(wrapping_integers_equivalence)
 
 ttest(recv_connect)
 ttest(recv_transmit)
@@ -45,6 +50,9 @@ ttest(recv_reorder)
 ttest(recv_reorder_more)
 ttest(recv_close)
 ttest(recv_special)
+ttest(recv_sack)
+ttest(recv_window_scale)
+ttest(recv_timestamps)
 
 ttest(send_connect)
 ttest(send_transmit)
@@ -53,6 +61,20 @@ ttest(send_ack)
 ttest(send_close)
 ttest(send_retx)
 ttest(send_extra)
+ttest(send_congestion)
+ttest(send_rto)
+ttest(send_sack)
+ttest(send_window_scale)
+ttest(send_timestamps)
+ttest(send_mss)
+ttest(send_pacing)
+ttest(send_nagle)
+ttest(send_autosize)
+ttest(tcp_options)
+ttest(tcp_gso)
+ttest(tcp_delayed_ack)
+ttest(tcp_linger)
+ttest(tcp_mss)
 
 ttest(net_interface)
 
@@ -94,3 +116,7 @@ set_tests_properties(${compile_name_opt} PROPERTIES FIXTURES_SETUP compile_opt)
 
 stest(byte_stream_speed_test)
 stest(reassembler_speed_test)
+stest(reassembler_scenario_speed_test)
+stest(spsc_byte_stream_speed_test)
+stest(tcp_congestion_speed_test)
+stest(wrapping_integers_speed_test)
@@ -3,7 +3,12 @@
 #include <string_view>
 using namespace std;
 
-ByteStream::ByteStream( uint64_t capacity ) : capacity_( capacity ) {}
+ByteStream::ByteStream( uint64_t capacity, Storage storage ) : capacity_( capacity ), storage_( storage )
+{
+  if ( storage_ == Storage::Ring ) {
+    buffer_.resize( capacity_ ); // 环形缓冲区一次性分配好，之后不再扩容
+  }
+}
 
 void Writer::push( string data )
 {
@@ -14,6 +19,28 @@ void Writer::push( string data )
   if ( writable == 0 )
     return; // 如果不能写 也不能push进来
 
+  if ( storage_ == Storage::Ring ) {
+    uint64_t len = min<uint64_t>( data.size(), writable );
+    uint64_t pos = offset_ + ( haveWritten_ - haveRead_ ); // 写指针在环中的位置
+    pos = pos >= capacity_ ? pos - capacity_ : pos;        // 避免每次取模
+    uint64_t first = min( len, capacity_ - pos );          // 到环尾为止能写多少
+    data.copy( buffer_.data() + pos, first );              // 第一段
+    data.copy( buffer_.data(), len - first, first );       // 绕回环头的第二段
+    haveWritten_ += len;
+    return;
+  }
+
+  if ( storage_ == Storage::Chunked ) {
+    if ( data.size() > writable ) {
+      data.resize( writable ); // 截断不会拷贝
+    }
+    if ( !data.empty() ) {
+      haveWritten_ += data.size();
+      chunks_.push_back( std::move( data ) ); // 直接接管这个 string
+    }
+    return;
+  }
+
   if ( data.size() <= writable ) {
     haveWritten_ += data.size();
     buffer_ += std::move( data ); // 如果可以读进来 直接 move 夺取
@@ -23,6 +50,47 @@ void Writer::push( string data )
   }
 }
 
+vector<span<char>> Writer::writable_regions()
+{
+  vector<span<char>> regions;
+  if ( storage_ != Storage::Ring || is_closed() || available_capacity() == 0 ) {
+    return regions;
+  }
+  uint64_t pos = offset_ + ( haveWritten_ - haveRead_ ); // 写指针在环中的位置
+  pos = pos >= capacity_ ? pos - capacity_ : pos;
+  uint64_t first = min( available_capacity(), capacity_ - pos );
+  regions.emplace_back( buffer_.data() + pos, first ); // 环尾之前的空闲空间
+  if ( available_capacity() > first ) {
+    regions.emplace_back( buffer_.data(), available_capacity() - first ); // 绕回环头的空闲空间
+  }
+  return regions;
+}
+
+void Writer::commit( uint64_t len )
+{
+  if ( storage_ != Storage::Ring || is_closed() ) {
+    return;
+  }
+  haveWritten_ += min( len, available_capacity() );
+}
+
+void Writer::grow_capacity( uint64_t capacity )
+{
+  if ( capacity <= capacity_ ) {
+    return;
+  }
+  if ( storage_ == Storage::Ring ) {
+    uint64_t buffered = haveWritten_ - haveRead_;
+    uint64_t first = min( buffered, capacity_ - offset_ ); // 环尾之前的一段
+    string grown( capacity, '\0' );
+    buffer_.copy( grown.data(), first, offset_ );
+    buffer_.copy( grown.data() + first, buffered - first, 0 ); // 绕回环头的一段
+    buffer_ = move( grown );
+    offset_ = 0;
+  }
+  capacity_ = capacity; // Contiguous 和 Chunked 只是上限变大
+}
+
 void Writer::close()
 {
   writeClosed_ = true;
@@ -45,16 +113,70 @@ uint64_t Writer::bytes_pushed() const
 
 string_view Reader::peek() const
 {
+  if ( storage_ == Storage::Ring ) {
+    if ( bytes_buffered() == 0 ) {
+      return {};
+    }
+    return std::string_view( buffer_ ).substr( offset_, min( bytes_buffered(), capacity_ - offset_ ) ); // 连续的一段
+  }
+  if ( storage_ == Storage::Chunked ) {
+    if ( chunks_.empty() ) {
+      return {};
+    }
+    return std::string_view( chunks_.front() ).substr( offset_ ); // 队首块剩下的部分
+  }
   return std::string_view( buffer_ ).substr( offset_ ); // string_view 优化获取子串
 }
 
+vector<string_view> Reader::peek_regions( uint64_t max_len ) const
+{
+  vector<string_view> regions;
+  uint64_t remaining = min( max_len, bytes_buffered() );
+  if ( remaining == 0 ) {
+    return regions;
+  }
+  if ( storage_ == Storage::Ring ) {
+    string_view first = peek().substr( 0, remaining ); // 环尾之前的一段
+    regions.push_back( first );
+    if ( remaining > first.size() ) {
+      regions.push_back( string_view( buffer_ ).substr( 0, remaining - first.size() ) ); // 绕回环头的一段
+    }
+    return regions;
+  }
+  if ( storage_ == Storage::Chunked ) {
+    uint64_t skip = offset_;
+    for ( const auto& chunk : chunks_ ) {
+      if ( remaining == 0 ) {
+        break;
+      }
+      regions.push_back( string_view( chunk ).substr( skip, remaining ) ); // 每块一段
+      remaining -= regions.back().size();
+      skip = 0;
+    }
+    return regions;
+  }
+  regions.push_back( peek().substr( 0, remaining ) );
+  return regions;
+}
+
 void Reader::pop( uint64_t len )
 {
-  len = min( len, buffer_.size() - offset_ ); // 实际能 pop 多少
+  len = min( len, bytes_buffered() ); // 实际能 pop 多少
   if ( len == 0 )
     return;
-  offset_ += len;
   haveRead_ += len;
+  offset_ += len;
+  if ( storage_ == Storage::Ring ) {
+    offset_ = offset_ >= capacity_ ? offset_ - capacity_ : offset_; // 环形缓冲区只需移动读指针
+    return;
+  }
+  if ( storage_ == Storage::Chunked ) {
+    while ( !chunks_.empty() && offset_ >= chunks_.front().size() ) {
+      offset_ -= chunks_.front().size(); // 读完的块直接丢掉
+      chunks_.pop_front();
+    }
+    return;
+  }
   if ( offset_ > 8192 ) {
     buffer_.erase( 0, offset_ );
     offset_ = 0; // offset优化erase次数
@@ -63,15 +185,15 @@ void Reader::pop( uint64_t len )
 
 bool Reader::is_finished() const
 {
-  return writeClosed_ && buffer_.size() == offset_;
+  return writeClosed_ && bytes_buffered() == 0;
 }
 
 uint64_t Reader::bytes_buffered() const
 {
-  return buffer_.size() - offset_;
+  return haveWritten_ - haveRead_;
 }
 
 uint64_t Reader::bytes_popped() const
 {
   return haveRead_;
-}
\ No newline at end of file
+}
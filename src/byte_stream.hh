@@ -1,17 +1,31 @@
 #pragma once // 表示这个头文件只会被包含一次，防止重复包含（等同于传统的 include guard）。
 
 #include <cstdint>     //cstdint: 提供固定宽度的整数类型（如 uint64_t）。
+#include <deque>       //deque: Chunked 模式下按块保存数据。
+#include <span>        //span: writable_regions 返回可以直接写入的空闲空间。
 #include <string>      //string: 用于数据存储的缓冲区。
 #include <string_view> //string_view: 提供轻量的字符串读取视图，不拷贝数据。
+#include <vector>      //vector: peek_regions 返回多个连续段。
 
 class Reader;
 class Writer;
+class FileDescriptor;
+class SPSCByteStream;
 
 class ByteStream // 这个类是流的核心，用来维护缓冲区（一个字符串）及其读写状态。
 {
 public:
-  explicit ByteStream( uint64_t capacity ); // 构造函数：显式构造 ByteStream，传入缓冲区最大容量。 explicit
-                                            // 的作用是：防止构造函数发生“隐式类型转换”（implicit conversion）。
+  // 缓冲区的存储方式
+  enum class Storage : uint8_t
+  {
+    Contiguous, // 连续字符串：push 时追加，pop 越过 8192 字节后 erase 压缩
+    Ring,       // 定长环形缓冲区：构造时一次性分配 capacity 字节，之后不再扩容也不压缩
+    Chunked,    // 分块（rope）：直接接管 push 进来的 string，push 不拷贝字节
+  };
+
+  explicit ByteStream( uint64_t capacity,
+                       Storage storage = Storage::Contiguous ); // 构造函数：显式构造 ByteStream，传入缓冲区最大容量。
+                                                                // explicit 的作用是：防止构造函数发生“隐式类型转换”。
 
   // Helper functions (provided) to access the ByteStream's Reader and Writer interfaces
   // 返回类型：Reader&  返回一个 Reader 的引用；
@@ -26,15 +40,21 @@ public:
   void set_error() { error_ = true; };       // Signal that the stream suffered an error.
   bool has_error() const { return error_; }; // Has the stream had an error?
 
+  Storage storage() const { return storage_; } // 当前使用的存储方式
+
 protected:
   // Please add any additional state to the ByteStream here, and not to the Writer and Reader interfaces.
-  std::string buffer_ {};   // 缓冲区
+  std::string buffer_ {};   // 缓冲区（Ring 模式下大小固定为 capacity_）
   bool writeClosed_ {};     // 写是否关闭
   uint64_t haveWritten_ {}; // 写了多少
   uint64_t haveRead_ {};    // 读了多少
   uint64_t capacity_ {};    // 最大容量
-  uint64_t offset_ {};      // 偏移量 用来优化pop
+  uint64_t offset_ {};      // 偏移量 用来优化pop（Ring：环中的读指针；Chunked：队首块内的偏移）
   bool error_ {};           // 是否错误
+  Storage storage_ {};      // 存储方式
+
+  // Chunked 模式下的数据块，每块都是 push 时接管的 string
+  std::deque<std::string> chunks_ {};
 };
 
 class Writer : public ByteStream
@@ -46,12 +66,21 @@ public:
   bool is_closed() const;              // Has the stream been closed?
   uint64_t available_capacity() const; // How many bytes can be pushed to the stream right now?
   uint64_t bytes_pushed() const;       // Total number of bytes cumulatively pushed to the stream
+
+  // 直接暴露缓冲区中的空闲空间（只有 Ring 模式有，其他模式返回空），写进去之后用 commit 确认写了多少
+  std::vector<std::span<char>> writable_regions();
+  void commit( uint64_t len ); // 确认已经往 writable_regions() 里写了 len 字节
+
+  // 在线把容量扩大到 capacity（不比现在大就什么也不做）；Ring 模式会重新分配并把数据挪到环头
+  void grow_capacity( uint64_t capacity );
 };
 
 class Reader : public ByteStream
 {
 public:                          // peek的意思：喵一眼
   std::string_view peek() const; // Peek at the next bytes in the buffer 查看当前缓冲区中可读的内容（不移除数据）。
+  // 一次看到缓冲区里全部（最多 max_len 字节）可读的内容，按存储上的连续段切分，可以直接交给 writev
+  std::vector<std::string_view> peek_regions( uint64_t max_len = UINT64_MAX ) const;
   void pop( uint64_t len ); // Remove `len` bytes from the buffer
 
   bool is_finished() const;        // Is the stream finished (closed and fully popped)?
@@ -63,4 +92,16 @@ public:                          // peek的意思：喵一眼
  * read: A (provided) helper function thats peeks and pops up to `max_len` bytes
  * from a ByteStream Reader into a string;
  */
-void read( Reader& reader, uint64_t max_len, std::string& out );
\ No newline at end of file
+void read( Reader& reader, uint64_t max_len, std::string& out );
+
+/*
+ * read_into: A helper function that reads from `fd` straight into the free space
+ * of a ByteStream Writer (one readv, no temporary string when the stream uses Ring storage).
+ */
+void read_into( FileDescriptor& fd, Writer& writer );
+
+/*
+ * read_into: The same from an SPSCByteStream (the reader side of it): copies as much as
+ * fits straight into the Writer's free space and pops it.
+ */
+void read_into( SPSCByteStream& pipe, Writer& writer );
\ No newline at end of file
@@ -1,7 +1,12 @@
 #include "byte_stream.hh"
+#include "file_descriptor.hh"
+#include "spsc_byte_stream.hh"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <stdexcept>
+#include <string_view>
 
 using namespace std;
 
@@ -26,6 +31,64 @@ void read( Reader& reader, uint64_t max_len, string& out )
   }
 }
 
+/*
+ * read_into: A helper function that reads from `fd` into the free space of a ByteStream Writer
+ */
+void read_into( FileDescriptor& fd, Writer& writer )
+{
+  if ( writer.available_capacity() == 0 ) {
+    return;
+  }
+
+  auto regions = writer.writable_regions();
+  if ( regions.empty() ) {
+    // No in-place free space (not Ring storage): fall back to a temporary string.
+    string data;
+    data.resize( writer.available_capacity() );
+    fd.read( data );
+    writer.push( move( data ) );
+    return;
+  }
+
+  writer.commit( fd.read( regions ) );
+}
+
+/*
+ * read_into: A helper function that moves bytes from an SPSCByteStream into the free space of a ByteStream Writer
+ */
+void read_into( SPSCByteStream& pipe, Writer& writer )
+{
+  auto regions = writer.writable_regions();
+  if ( regions.empty() ) {
+    // No in-place free space (not Ring storage): fall back to a temporary string.
+    const string_view view = pipe.peek();
+    const uint64_t len = min<uint64_t>( view.size(), writer.available_capacity() );
+    writer.push( string { view.substr( 0, len ) } );
+    pipe.pop( len );
+    return;
+  }
+
+  uint64_t copied = 0;
+  for ( const auto region : regions ) {
+    uint64_t filled = 0;
+    while ( filled < region.size() ) {
+      const string_view view = pipe.peek();
+      if ( view.empty() ) {
+        break;
+      }
+      const uint64_t len = min<uint64_t>( view.size(), region.size() - filled );
+      memcpy( region.data() + filled, view.data(), len );
+      pipe.pop( len );
+      filled += len;
+    }
+    copied += filled;
+    if ( filled < region.size() ) {
+      break;
+    }
+  }
+  writer.commit( copied );
+}
+
 Reader& ByteStream::reader()
 {
   static_assert( sizeof( Reader ) == sizeof( ByteStream ),
@@ -0,0 +1,240 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+void Reno::on_ack( uint64_t acked, uint64_t /*bytes_in_flight*/, uint64_t /*now_ms*/ )
+{
+  if ( in_slow_start() ) {
+    cwnd_ += min( acked, mss_ ); // 慢启动：每个 ack 最多加一个 MSS
+    return;
+  }
+  bytes_acked_ += acked;
+  if ( bytes_acked_ >= cwnd_ ) {
+    bytes_acked_ -= cwnd_;
+    cwnd_ += mss_; // 拥塞避免：每个 RTT 加一个 MSS
+  }
+}
+
+void Reno::on_timeout( uint64_t bytes_in_flight, uint64_t /*now_ms*/ )
+{
+  ssthresh_ = max( bytes_in_flight / 2, 2 * mss_ );
+  cwnd_ = mss_; // 超时后从一个 MSS 重新慢启动
+  bytes_acked_ = 0;
+}
+
+void Reno::on_fast_retransmit( uint64_t bytes_in_flight, uint64_t /*now_ms*/ )
+{
+  ssthresh_ = max( bytes_in_flight / 2, 2 * mss_ );
+  cwnd_ = ssthresh_ + 3 * mss_; // 三个重复 ack 代表三个段已经离开网络
+  bytes_acked_ = 0;
+}
+
+void Cubic::on_ack( uint64_t acked, uint64_t /*bytes_in_flight*/, uint64_t now_ms )
+{
+  if ( in_slow_start() ) {
+    cwnd_ += min( acked, mss_ );
+    return;
+  }
+
+  const double mss = static_cast<double>( mss_ );
+  const double cwnd = static_cast<double>( cwnd_ );
+  if ( not epoch_started_ ) {
+    epoch_started_ = true;
+    epoch_start_ms_ = now_ms;
+    if ( w_max_ < cwnd ) {
+      w_max_ = cwnd; // 没有丢过包（或已经超过 W_max）：从当前窗口开始凸增长
+    }
+    k_ = cbrt( ( w_max_ - cwnd ) / mss / C );
+    w_est_ = cwnd;
+  }
+
+  const double t = static_cast<double>( now_ms - epoch_start_ms_ ) / 1000.0;
+  const double target = w_max_ + C * pow( t - k_, 3 ) * mss;
+  w_est_ += 3 * ( 1 - BETA ) / ( 1 + BETA ) * static_cast<double>( acked ) / cwnd * mss; // RFC 9438 4.3
+
+  const double goal = max( target, w_est_ );
+  if ( goal > cwnd ) {
+    cwnd_fraction_ += ( goal - cwnd ) / cwnd * static_cast<double>( min( acked, mss_ ) );
+  } else {
+    cwnd_fraction_ += mss / cwnd / 100; // 平台期缓慢增长
+  }
+  // 按整 MSS 增长，否则窗口边缘会切出零碎的小段
+  const auto segments = static_cast<uint64_t>( cwnd_fraction_ / mss );
+  cwnd_ += segments * mss_;
+  cwnd_fraction_ -= static_cast<double>( segments ) * mss;
+}
+
+void Cubic::reduce()
+{
+  const double cwnd = static_cast<double>( cwnd_ );
+  // 快速收敛：窗口还没回到上次的 W_max 就又丢包，说明有新流加入，让出更多带宽
+  w_max_ = cwnd < w_max_ ? cwnd * ( 1 + BETA ) / 2 : cwnd;
+  ssthresh_ = max( static_cast<uint64_t>( cwnd * BETA ), 2 * mss_ );
+  epoch_started_ = false;
+  cwnd_fraction_ = 0;
+}
+
+void Cubic::on_timeout( uint64_t /*bytes_in_flight*/, uint64_t /*now_ms*/ )
+{
+  reduce();
+  cwnd_ = mss_;
+}
+
+void Cubic::on_fast_retransmit( uint64_t /*bytes_in_flight*/, uint64_t /*now_ms*/ )
+{
+  reduce();
+  cwnd_ = ssthresh_ + 3 * mss_;
+}
+
+uint64_t BBR::bottleneck_bandwidth() const
+{
+  return *max_element( bw_samples_.begin(), bw_samples_.end() );
+}
+
+uint64_t BBR::bdp( double gain ) const
+{
+  if ( min_rtt_ms_ == UINT64_MAX || bottleneck_bandwidth() == 0 ) {
+    return INITIAL_WINDOW * mss_; // 还没有模型
+  }
+  return static_cast<uint64_t>( gain * static_cast<double>( bottleneck_bandwidth() * min_rtt_ms_ ) / 1000 );
+}
+
+uint64_t BBR::pacing_rate() const
+{
+  return static_cast<uint64_t>( pacing_gain_ * static_cast<double>( bottleneck_bandwidth() ) );
+}
+
+void BBR::on_rate_sample( const RateSample& sample, uint64_t now_ms )
+{
+  // 被确认的段是在本轮开始之后发出的，说明又过了一个来回
+  round_start_ = sample.prior_delivered >= next_round_delivered_;
+  if ( round_start_ ) {
+    next_round_delivered_ = sample.delivered;
+    round_count_++;
+    bw_samples_[round_count_ % BW_WINDOW_ROUNDS] = 0; // 最老的一轮滑出窗口
+  }
+
+  // 应用受限的样本偏低，只有超过当前估计时才采用
+  if ( !sample.is_app_limited || sample.delivery_rate >= bottleneck_bandwidth() ) {
+    auto& slot = bw_samples_[round_count_ % BW_WINDOW_ROUNDS];
+    slot = max( slot, sample.delivery_rate );
+  }
+
+  min_rtt_expired_ = now_ms > min_rtt_stamp_ms_ + MIN_RTT_WINDOW_MS;
+  if ( sample.rtt_ms > 0 && ( sample.rtt_ms <= min_rtt_ms_ || min_rtt_expired_ ) ) {
+    min_rtt_ms_ = sample.rtt_ms;
+    min_rtt_stamp_ms_ = now_ms;
+  }
+
+  if ( round_start_ && !sample.is_app_limited ) {
+    check_full_pipe();
+  }
+}
+
+void BBR::check_full_pipe()
+{
+  if ( filled_pipe_ ) {
+    return;
+  }
+  const uint64_t bw = bottleneck_bandwidth();
+  if ( bw * 4 >= full_bw_ * 5 ) {
+    full_bw_ = bw; // 带宽还在以 25% 以上的速度增长
+    full_bw_rounds_ = 0;
+    return;
+  }
+  if ( ++full_bw_rounds_ >= 3 ) {
+    filled_pipe_ = true;
+  }
+}
+
+void BBR::update_mode( uint64_t bytes_in_flight, uint64_t now_ms )
+{
+  switch ( mode_ ) {
+    case Mode::Startup:
+      if ( filled_pipe_ ) {
+        mode_ = Mode::Drain;
+        pacing_gain_ = 1 / HIGH_GAIN;
+      }
+      break;
+    case Mode::Drain:
+      if ( bytes_in_flight <= bdp( 1 ) ) {
+        mode_ = Mode::ProbeBW;
+        cycle_index_ = 2; // 从增益为 1 的阶段开始
+        cycle_stamp_ms_ = now_ms;
+        pacing_gain_ = PROBE_BW_GAINS[cycle_index_];
+        cwnd_gain_ = 2;
+      }
+      break;
+    case Mode::ProbeBW:
+      if ( now_ms - cycle_stamp_ms_ > min_rtt_ms_ ) {
+        cycle_index_ = ( cycle_index_ + 1 ) % PROBE_BW_GAINS.size(); // 每个最小 RTT 换一个增益
+        cycle_stamp_ms_ = now_ms;
+        pacing_gain_ = PROBE_BW_GAINS[cycle_index_];
+      }
+      break;
+    case Mode::ProbeRTT:
+      if ( now_ms >= probe_rtt_done_ms_ ) {
+        min_rtt_stamp_ms_ = now_ms;
+        cwnd_ = max( cwnd_, prior_cwnd_ );
+        if ( filled_pipe_ ) {
+          mode_ = Mode::ProbeBW;
+          cycle_stamp_ms_ = now_ms;
+          pacing_gain_ = PROBE_BW_GAINS[cycle_index_];
+          cwnd_gain_ = 2;
+        } else {
+          mode_ = Mode::Startup;
+          pacing_gain_ = cwnd_gain_ = HIGH_GAIN;
+        }
+      }
+      break;
+  }
+
+  if ( mode_ != Mode::ProbeRTT && min_rtt_expired_ ) {
+    mode_ = Mode::ProbeRTT; // 最小 RTT 太久没更新了
+    pacing_gain_ = cwnd_gain_ = 1;
+    prior_cwnd_ = cwnd_;
+    probe_rtt_done_ms_ = now_ms + PROBE_RTT_MS;
+    min_rtt_expired_ = false;
+  }
+}
+
+void BBR::on_ack( uint64_t acked, uint64_t bytes_in_flight, uint64_t now_ms )
+{
+  update_mode( bytes_in_flight, now_ms );
+  if ( mode_ == Mode::ProbeRTT ) {
+    cwnd_ = MIN_CWND_SEGMENTS * mss_;
+    return;
+  }
+  const uint64_t target = bdp( cwnd_gain_ ) + 3 * mss_; // 多留几个段应对 ack 聚合
+  if ( filled_pipe_ ) {
+    cwnd_ = min( cwnd_ + acked, target );
+  } else if ( cwnd_ < target ) {
+    cwnd_ += acked;
+  }
+  cwnd_ = max( cwnd_, MIN_CWND_SEGMENTS * mss_ );
+}
+
+void BBR::on_timeout( uint64_t /*bytes_in_flight*/, uint64_t /*now_ms*/ )
+{
+  cwnd_ = MIN_CWND_SEGMENTS * mss_; // 模型保留，下一个 ack 会把窗口拉回目标值
+}
+
+unique_ptr<CongestionControl> make_congestion_control( TCPConfig::Congestion algorithm, uint64_t mss )
+{
+  switch ( algorithm ) {
+    case TCPConfig::Congestion::Reno:
+      return make_unique<Reno>( mss, false );
+    case TCPConfig::Congestion::NewReno:
+      return make_unique<Reno>( mss, true );
+    case TCPConfig::Congestion::Cubic:
+      return make_unique<Cubic>( mss );
+    case TCPConfig::Congestion::BBR:
+      return make_unique<BBR>( mss );
+    case TCPConfig::Congestion::None:
+      break;
+  }
+  return nullptr;
+}
@@ -0,0 +1,196 @@
+#pragma once
+
+#include "tcp_config.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+// 一次 ack 得到的投递速率和 RTT 样本
+struct RateSample
+{
+  uint64_t delivery_rate {};   // 字节/秒
+  uint64_t rtt_ms {};          // 0 表示没有有效样本（重传过的段不采样）
+  uint64_t delivered {};       // 到现在为止一共确认的字节数
+  uint64_t prior_delivered {}; // 被确认的段发出时已经确认的字节数
+  bool is_app_limited {};      // 段发出时应用没有数据可发，速率样本只能算下限
+};
+
+/*
+ * 拥塞控制算法的接口。TCPSender 在收到新的 ack、发生超时时通知它，
+ * 并用 min(cwnd, 对端窗口) 作为发送窗口。窗口都以字节为单位。
+ */
+class CongestionControl
+{
+public:
+  explicit CongestionControl( uint64_t mss ) : mss_( mss ), cwnd_( INITIAL_WINDOW * mss ) {}
+  virtual ~CongestionControl() = default;
+
+  CongestionControl( const CongestionControl& ) = delete;
+  CongestionControl& operator=( const CongestionControl& ) = delete;
+
+  // 有 acked 个序号被新确认；bytes_in_flight 是确认之后仍在途的序号数，now_ms 是发送方的时钟
+  virtual void on_ack( uint64_t acked, uint64_t bytes_in_flight, uint64_t now_ms ) = 0;
+
+  // 重传计时器超时
+  virtual void on_timeout( uint64_t bytes_in_flight, uint64_t now_ms ) = 0;
+
+  // 三个重复 ack 触发快速重传，进入快速恢复：各算法自己决定怎么减小窗口
+  virtual void on_fast_retransmit( uint64_t bytes_in_flight, uint64_t now_ms ) = 0;
+
+  // 快速恢复期间又来一个重复 ack：又有一个段离开了网络，窗口膨胀一个 MSS（RFC 5681）
+  virtual void on_dupack() { cwnd_ += mss_; }
+
+  // 快速恢复期间的部分确认（RFC 6582）：减去确认的量，再加回一个 MSS
+  virtual void on_partial_ack( uint64_t acked, uint64_t /*bytes_in_flight*/, uint64_t /*now_ms*/ )
+  {
+    cwnd_ = cwnd_ - std::min( acked, cwnd_ ) + mss_;
+  }
+
+  // 快速恢复结束：窗口收回到 ssthresh，但不超过在途数据加一个 MSS，避免突发
+  virtual void on_recovery_exit( uint64_t bytes_in_flight, uint64_t /*now_ms*/ )
+  {
+    cwnd_ = std::min( ssthresh_, std::max( bytes_in_flight, mss_ ) + mss_ );
+  }
+
+  // 部分确认是否留在快速恢复里继续重传下一个空洞（NewReno）；经典 Reno 收到任何新确认就退出
+  virtual bool recovers_on_partial_ack() const { return true; }
+
+  // 每次有新数据被确认时，在 on_ack 之前给出速率样本；基于丢包的算法用不到
+  virtual void on_rate_sample( const RateSample& /*sample*/, uint64_t /*now_ms*/ ) {}
+
+  // 发送速率上限（字节/秒），0 表示不做 pacing
+  virtual uint64_t pacing_rate() const { return 0; }
+
+  virtual std::string_view name() const = 0;
+
+  // 握手时协商出新的 MSS：按段数保持窗口不变（连接刚建立，一般还是初始窗口）
+  void set_mss( uint64_t mss )
+  {
+    cwnd_ = cwnd_ / mss_ * mss;
+    mss_ = mss;
+  }
+
+  uint64_t mss() const { return mss_; }
+  uint64_t cwnd() const { return cwnd_; }
+  uint64_t ssthresh() const { return ssthresh_; }
+  bool in_slow_start() const { return cwnd_ < ssthresh_; }
+
+  static constexpr uint64_t INITIAL_WINDOW = 10; // RFC 6928，单位 MSS
+
+protected:
+  uint64_t mss_;
+  uint64_t cwnd_;
+  uint64_t ssthresh_ = UINT64_MAX;
+};
+
+// RFC 5681：慢启动 + 拥塞避免（按确认字节数计数，RFC 3465）
+class Reno : public CongestionControl
+{
+public:
+  Reno( uint64_t mss, bool newreno ) : CongestionControl( mss ), newreno_( newreno ) {}
+
+  void on_ack( uint64_t acked, uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_timeout( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_fast_retransmit( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  bool recovers_on_partial_ack() const override { return newreno_; }
+  std::string_view name() const override { return newreno_ ? "newreno" : "reno"; }
+
+private:
+  bool newreno_;
+  uint64_t bytes_acked_ {}; // 拥塞避免阶段累计确认的字节，攒够一个 cwnd 就加一个 MSS
+};
+
+// RFC 9438 CUBIC：窗口按距上次丢包的时间的三次函数增长
+class Cubic : public CongestionControl
+{
+public:
+  explicit Cubic( uint64_t mss ) : CongestionControl( mss ) {}
+
+  void on_ack( uint64_t acked, uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_timeout( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_fast_retransmit( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  std::string_view name() const override { return "cubic"; }
+
+  static constexpr double C = 0.4;
+  static constexpr double BETA = 0.7;
+
+private:
+  void reduce(); // 丢包时记录 W_max 并乘性减小 ssthresh
+
+  double w_max_ {};            // 上次丢包时的窗口（字节）
+  double w_est_ {};            // 同样条件下 Reno 的窗口估计，保证不比 Reno 慢
+  double k_ {};                // 窗口回到 W_max 所需的时间（秒）
+  double cwnd_fraction_ {};    // 不足一个 MSS 的增长先攒着
+  bool epoch_started_ {};      // 当前拥塞避免阶段是否已经开始计时
+  uint64_t epoch_start_ms_ {}; // 当前拥塞避免阶段开始的时间
+};
+
+// BBR（v1）：用最大投递速率和最小 RTT 估计瓶颈带宽和 BDP，按模型限速发送，不把随机丢包当作拥塞
+class BBR : public CongestionControl
+{
+public:
+  explicit BBR( uint64_t mss ) : CongestionControl( mss ) {}
+
+  enum class Mode : uint8_t
+  {
+    Startup,  // 指数增长，直到带宽不再上涨
+    Drain,    // 排空 Startup 在瓶颈队列里积压的数据
+    ProbeBW,  // 按增益周期探测更多带宽
+    ProbeRTT, // 把在途数据压到最低，重新测量最小 RTT
+  };
+
+  void on_rate_sample( const RateSample& sample, uint64_t now_ms ) override;
+  void on_ack( uint64_t acked, uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_timeout( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  uint64_t pacing_rate() const override;
+
+  // 丢包不改变模型：快速恢复期间窗口照常跟着模型走
+  void on_fast_retransmit( uint64_t /*bytes_in_flight*/, uint64_t /*now_ms*/ ) override {}
+  void on_dupack() override {}
+  void on_partial_ack( uint64_t acked, uint64_t bytes_in_flight, uint64_t now_ms ) override
+  {
+    on_ack( acked, bytes_in_flight, now_ms );
+  }
+  void on_recovery_exit( uint64_t /*bytes_in_flight*/, uint64_t /*now_ms*/ ) override {}
+  std::string_view name() const override { return "bbr"; }
+
+  Mode mode() const { return mode_; }
+  uint64_t bottleneck_bandwidth() const; // 字节/秒，最近 BW_WINDOW_ROUNDS 轮的最大投递速率
+  uint64_t min_rtt_ms() const { return min_rtt_ms_; }
+
+  static constexpr double HIGH_GAIN = 2.885; // 2/ln2：Startup 每轮翻倍
+  static constexpr std::array<double, 8> PROBE_BW_GAINS { 1.25, 0.75, 1, 1, 1, 1, 1, 1 };
+  static constexpr uint64_t BW_WINDOW_ROUNDS = 10;
+  static constexpr uint64_t MIN_RTT_WINDOW_MS = 10000;
+  static constexpr uint64_t PROBE_RTT_MS = 200;
+  static constexpr uint64_t MIN_CWND_SEGMENTS = 4;
+
+private:
+  uint64_t bdp( double gain ) const; // gain × 带宽 × 最小 RTT
+  void check_full_pipe(); // 带宽连续三轮涨不到 25%，认为已经占满瓶颈
+  void update_mode( uint64_t bytes_in_flight, uint64_t now_ms );
+
+  Mode mode_ = Mode::Startup;
+  std::array<uint64_t, BW_WINDOW_ROUNDS> bw_samples_ {}; // 每轮的最大速率，按轮数取模存放
+  uint64_t round_count_ {};
+  uint64_t next_round_delivered_ {};
+  bool round_start_ {};
+  uint64_t min_rtt_ms_ = UINT64_MAX;
+  uint64_t min_rtt_stamp_ms_ {};
+  bool min_rtt_expired_ {};
+  uint64_t probe_rtt_done_ms_ {};
+  uint64_t prior_cwnd_ {}; // 进入 ProbeRTT 前的窗口，退出时恢复
+  double pacing_gain_ = HIGH_GAIN;
+  double cwnd_gain_ = HIGH_GAIN;
+  uint64_t full_bw_ {};
+  uint64_t full_bw_rounds_ {};
+  bool filled_pipe_ {};
+  uint64_t cycle_index_ {};
+  uint64_t cycle_stamp_ms_ {};
+};
+
+// 按配置创建拥塞控制算法；Congestion::None 返回空指针
+std::unique_ptr<CongestionControl> make_congestion_control( TCPConfig::Congestion algorithm, uint64_t mss );
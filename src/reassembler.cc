@@ -2,6 +2,7 @@
 #include "debug.hh"
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <sys/types.h>
 
@@ -56,6 +57,57 @@ uint64_t DynamicBitset::find_first_zero_from( uint64_t start ) const
   return bitset.size() * 64;
 }
 
+uint64_t DynamicBitset::find_first_one_from( uint64_t start, uint64_t limit ) const
+{
+  uint64_t end_block = min<uint64_t>( bitset.size(), limit / 64 + 1 ); // 稀疏时不必扫到末尾
+  for ( uint64_t block = start / 64; block < end_block; ++block ) {
+    uint64_t block_bits = bitset[block];
+    if ( block == start / 64 ) {
+      block_bits &= ~( ( 1ULL << ( start % 64 ) ) - 1 ); // 起始块中 start 之前的位当作 0
+    }
+    if ( block_bits != 0 ) {
+      return block * 64 + __builtin_ctzll( block_bits ); // 最低的 1
+    }
+  }
+  return bitset.size() * 64;
+}
+
+// [begin, end) 在第 block 块中对应的掩码
+static uint64_t block_mask( uint64_t block, uint64_t begin, uint64_t end )
+{
+  uint64_t mask = ~0ULL;
+  if ( block == begin / 64 ) {
+    mask &= ~0ULL << ( begin % 64 );
+  }
+  if ( block == ( end - 1 ) / 64 ) {
+    mask &= ~0ULL >> ( 63 - ( end - 1 ) % 64 );
+  }
+  return mask;
+}
+
+void DynamicBitset::set_range( uint64_t begin, uint64_t end )
+{
+  for ( uint64_t block = begin / 64; begin < end && block <= ( end - 1 ) / 64; ++block ) {
+    bitset[block] |= block_mask( block, begin, end ); // 一次处理 64 位
+  }
+}
+
+void DynamicBitset::reset_range( uint64_t begin, uint64_t end )
+{
+  for ( uint64_t block = begin / 64; begin < end && block <= ( end - 1 ) / 64; ++block ) {
+    bitset[block] &= ~block_mask( block, begin, end );
+  }
+}
+
+uint64_t DynamicBitset::count_range( uint64_t begin, uint64_t end ) const
+{
+  uint64_t count = 0;
+  for ( uint64_t block = begin / 64; begin < end && block <= ( end - 1 ) / 64; ++block ) {
+    count += __builtin_popcountll( bitset[block] & block_mask( block, begin, end ) ); // popcount 统计
+  }
+  return count;
+}
+
 // 查找下一个为 0 的位，返回严格大于 start 的位置
 uint64_t DynamicBitset::find_next( uint64_t start ) const
 {
@@ -72,37 +124,236 @@ void Reassembler::insert( uint64_t first_index, string data, bool is_last_substr
   if ( is_last_substring ) {
     eof_len_ = first_index + data.size(); // 记录eoflen
   }
+  if ( backend_ == Backend::IntervalMap ) {
+    insert_interval( first_index, move( data ) );
+  } else {
+    insert_dense( first_index, move( data ) );
+  }
+  if ( eof_len_ != static_cast<uint64_t>( -1 ) && output_.writer().bytes_pushed() == eof_len_ ) {
+    output_.writer().close();
+  }
+}
+
+void Reassembler::insert_dense( uint64_t first_index, string data )
+{
   auto read_end = output_.writer().bytes_pushed();                   // 已经推了多少进去
   auto write_end = read_end + output_.writer().available_capacity(); // 最多能读多少
   auto loop_end = min( first_index + data.size(), write_end );       // 和字符串的最后位置取最小值
-  if ( buffer_.size() < loop_end ) {
-    buffer_.resize( loop_end * 2, '\0' ); // 扩容 利用x2 导致最多扩容log次
-    is_inserted_.resize( loop_end * 2 );
-  }
-  for ( uint64_t i = is_inserted_.find_first_zero_from( max( first_index, read_end ) ); i < loop_end;
-        i = is_inserted_.find_next( i ) ) { // 利用动态bitset快速找到第一个没填的位置
-    buffer_[i] = data[i - first_index];
-    is_inserted_.set( i );
-    pending_bytes_++;
-  }
-  auto pre_read = read_end;
-  read_end = is_inserted_.find_first_zero_from( read_end ); // 利用动态bitset找到连续的1
-  string put( read_end - pre_read, '\0' );
-  for ( uint64_t i = pre_read; i < read_end; i++ )
-    put[i - pre_read] = buffer_[i];
-  auto pre_bytes = output_.writer().bytes_pushed();
-  output_.writer().push( move( put ) ); // move加速
-  auto suf_bytes = output_.writer().bytes_pushed();
-  pending_bytes_ -= suf_bytes - pre_bytes; // 读了多少进去
-  if ( eof_len_ != static_cast<uint64_t>( -1 ) && read_end == eof_len_ ) {
-    output_.writer().close();
+  if ( read_end == write_end ) {
+    return; // 窗口为 0
+  }
+
+  if ( first_index <= read_end && loop_end > read_end ) {
+    // 快速路径：数据正好接在已推出的前缀后面，直接把这个 string 移交给输出流，不经过环形缓冲区
+    data.resize( loop_end - first_index );
+    if ( first_index < read_end ) {
+      data.erase( 0, read_end - first_index );
+    }
+    if ( pending_bytes_ > 0 ) {
+      pending_bytes_ -= count_dense( read_end, loop_end );
+      mark_dense( read_end, loop_end, false ); // 已暂存的重叠部分作废
+    }
+    output_.writer().push( move( data ) );
+    if ( pending_bytes_ > 0 ) {
+      flush_dense(); // 后面可能接着暂存的数据
+    }
+    return;
+  }
+  if ( loop_end <= max( first_index, read_end ) ) {
+    return; // 空段、重复的段或者整个落在窗口外：没有新字节，不用碰环形缓冲区（也就不会先分配它）
+  }
+  uint64_t ring_size = output_.writer().available_capacity() + output_.reader().bytes_buffered(); // 流的容量
+  if ( buffer_.size() != ring_size ) {
+    buffer_.assign( ring_size, '\0' ); // 只分配一次，之后窗口在环上滑动
+    is_inserted_ = DynamicBitset( ring_size );
+  }
+
+  for ( uint64_t i = find_dense( max( first_index, read_end ), loop_end, false ); i < loop_end; ) {
+    // [i, j) 是一段还没填的连续位置，整段拷进环里（最多分两段）
+    uint64_t j = find_dense( i, loop_end, true );
+    uint64_t slot = i % ring_size;
+    uint64_t first = min( j - i, ring_size - slot );
+    memcpy( buffer_.data() + slot, data.data() + ( i - first_index ), first );
+    memcpy( buffer_.data(), data.data() + ( i - first_index ) + first, j - i - first );
+    mark_dense( i, j, true );
+    pending_bytes_ += j - i;
+    i = find_dense( j, loop_end, false );
+  }
+
+  flush_dense();
+}
+
+void Reassembler::flush_dense()
+{
+  auto read_end = output_.writer().bytes_pushed();
+  auto write_end = read_end + output_.writer().available_capacity();
+  auto flush_end = find_dense( read_end, write_end, false ); // 利用bitset找到连续的1
+  if ( flush_end == read_end ) {
+    return;
+  }
+  uint64_t ring_size = buffer_.size();
+  uint64_t slot = read_end % ring_size;
+  uint64_t first = min( flush_end - read_end, ring_size - slot );
+  string put( buffer_.data() + slot, first ); // 连续前缀最多两段拷贝
+  put.append( buffer_.data(), flush_end - read_end - first );
+  mark_dense( read_end, flush_end, false ); // 推出去的位置清零，留给后面的窗口
+  pending_bytes_ -= put.size();
+  output_.writer().push( move( put ) );
+}
+
+uint64_t Reassembler::count_dense( uint64_t begin, uint64_t end ) const
+{
+  if ( begin >= end ) {
+    return 0;
+  }
+  uint64_t ring_size = buffer_.size();
+  uint64_t slot = begin % ring_size;
+  uint64_t first = min( end - begin, ring_size - slot );
+  return is_inserted_.count_range( slot, slot + first ) + is_inserted_.count_range( 0, end - begin - first );
+}
+
+uint64_t Reassembler::find_dense( uint64_t begin, uint64_t end, bool value ) const
+{
+  if ( begin >= end ) {
+    return end;
+  }
+  auto find = [&]( uint64_t from, uint64_t limit ) {
+    return value ? is_inserted_.find_first_one_from( from, limit ) : is_inserted_.find_first_zero_from( from );
+  };
+  uint64_t ring_size = buffer_.size();
+  uint64_t slot = begin % ring_size;
+  uint64_t first = min( end - begin, ring_size - slot ); // 环尾之前的部分
+  uint64_t found = find( slot, slot + first );
+  if ( found < slot + first ) {
+    return begin + ( found - slot );
+  }
+  if ( first == end - begin ) {
+    return end;
+  }
+  return begin + first + min( find( 0, end - begin - first ), end - begin - first ); // 绕回环头继续找
+}
+
+void Reassembler::mark_dense( uint64_t begin, uint64_t end, bool value )
+{
+  if ( begin >= end ) {
+    return;
+  }
+  uint64_t ring_size = buffer_.size();
+  uint64_t slot = begin % ring_size;
+  uint64_t first = min( end - begin, ring_size - slot );
+  if ( value ) {
+    is_inserted_.set_range( slot, slot + first );
+    is_inserted_.set_range( 0, end - begin - first );
+  } else {
+    is_inserted_.reset_range( slot, slot + first );
+    is_inserted_.reset_range( 0, end - begin - first );
+  }
+}
+
+void Reassembler::insert_interval( uint64_t first_index, string data )
+{
+  auto read_end = output_.writer().bytes_pushed();
+  auto write_end = read_end + output_.writer().available_capacity();
+  uint64_t begin = max( first_index, read_end );
+  uint64_t end = min( first_index + data.size(), write_end );
+  if ( begin >= end ) {
+    return; // 全部已经推过了，或者全部超出窗口
+  }
+  data.resize( end - first_index ); // 先截掉窗口外的尾巴
+  data.erase( 0, begin - first_index );
+
+  // 左边和它重叠或相邻的区间：把那个区间的前半段接到前面
+  auto it = intervals_.upper_bound( begin );
+  if ( it != intervals_.begin() ) {
+    auto prev = std::prev( it );
+    uint64_t prev_end = prev->first + prev->second.size();
+    if ( prev_end >= end ) {
+      return; // 已经被完整覆盖
+    }
+    if ( prev_end >= begin ) {
+      prev->second.resize( begin - prev->first );
+      prev->second += data;
+      data = move( prev->second );
+      begin = prev->first;
+      intervals_.erase( prev );
+    }
+  }
+
+  // 右边被覆盖或相邻的区间：吞掉，只补上超出 end 的部分
+  while ( it != intervals_.end() && it->first <= end ) {
+    uint64_t it_end = it->first + it->second.size();
+    if ( it_end > end ) {
+      data.append( it->second, end - it->first );
+      end = it_end;
+    }
+    it = intervals_.erase( it );
+  }
+
+  if ( begin == read_end ) {
+    output_.writer().push( move( data ) ); // 接上了已推出的前缀，直接交给输出流，内存随之释放
+  } else {
+    intervals_.emplace( begin, move( data ) );
+  }
+}
+
+void Reassembler::grow_capacity( uint64_t capacity )
+{
+  if ( backend_ == Backend::IntervalMap || pending_bytes_ == 0 ) {
+    output_.writer().grow_capacity( capacity ); // 环形缓冲区下次用到时按新容量重新分配
+    return;
+  }
+  // 环上的位置是 绝对下标 % 环大小，环变大以后位置全变了：先把暂存的区间取出来，扩容后再插回去
+  vector<pair<uint64_t, string>> pending;
+  for ( auto [begin, end] : pending_intervals( SIZE_MAX ) ) {
+    uint64_t ring_size = buffer_.size();
+    uint64_t slot = begin % ring_size;
+    uint64_t first = min( end - begin, ring_size - slot );
+    string data( buffer_.data() + slot, first );
+    data.append( buffer_.data(), end - begin - first );
+    pending.emplace_back( begin, move( data ) );
+  }
+  output_.writer().grow_capacity( capacity );
+  buffer_.clear();
+  is_inserted_ = DynamicBitset( 0 );
+  pending_bytes_ = 0;
+  for ( auto& [begin, data] : pending ) {
+    insert_dense( begin, move( data ) );
   }
 }
 
+vector<pair<uint64_t, uint64_t>> Reassembler::pending_intervals( size_t max_count ) const
+{
+  vector<pair<uint64_t, uint64_t>> result;
+  if ( backend_ == Backend::IntervalMap ) {
+    for ( auto it = intervals_.begin(); it != intervals_.end() && result.size() < max_count; ++it ) {
+      result.emplace_back( it->first, it->first + it->second.size() );
+    }
+    return result;
+  }
+  if ( pending_bytes_ == 0 ) {
+    return result; // 环形缓冲区可能还没分配
+  }
+  auto read_end = output_.writer().bytes_pushed();
+  auto write_end = read_end + output_.writer().available_capacity();
+  for ( uint64_t i = find_dense( read_end, write_end, true ); i < write_end && result.size() < max_count; ) {
+    uint64_t j = find_dense( i, write_end, false );
+    result.emplace_back( i, j );
+    i = find_dense( j, write_end, true );
+  }
+  return result;
+}
+
 // How many bytes are stored in the Reassembler itself?
 // This function is for testing only; don't add extra state to support it.
 uint64_t Reassembler::count_bytes_pending() const
 {
+  if ( backend_ == Backend::IntervalMap ) {
+    uint64_t pending = 0;
+    for ( const auto& [begin, data] : intervals_ ) {
+      pending += data.size();
+    }
+    return pending;
+  }
   return pending_bytes_;
   // debug( "unimplemented count_bytes_pending() called" );
 }
@@ -2,6 +2,8 @@
 
 #include "byte_stream.hh"
 #include <cstdint>
+#include <map>
+#include <utility>
 #include <vector>
 
 class DynamicBitset
@@ -24,6 +26,18 @@ public:
   // 查找从这个位置开始第一个0
   uint64_t find_first_zero_from( uint64_t start ) const;
 
+  // 查找从这个位置开始第一个1，只扫描到 limit 为止
+  uint64_t find_first_one_from( uint64_t start, uint64_t limit = UINT64_MAX ) const;
+
+  // 把 [begin, end) 整段设置为 1
+  void set_range( uint64_t begin, uint64_t end );
+
+  // 把 [begin, end) 整段设置为 0
+  void reset_range( uint64_t begin, uint64_t end );
+
+  // 统计 [begin, end) 中 1 的个数
+  uint64_t count_range( uint64_t begin, uint64_t end ) const;
+
   // 获取指定位置的位值
   bool get( uint64_t index ) const;
 
@@ -34,8 +48,17 @@ private:
 class Reassembler
 {
 public:
+  // 乱序数据的存储方式
+  enum class Backend : uint8_t
+  {
+    Dense,       // 稠密缓冲区 + bitset
+    IntervalMap, // 有序 map 保存互不重叠的区间，每个区间持有自己的 string，内存只和乱序数据量有关
+  };
+
   // Construct Reassembler to write into given ByteStream.
-  explicit Reassembler( ByteStream&& output ) : output_( std::move( output ) ) {}
+  explicit Reassembler( ByteStream&& output, Backend backend = Backend::Dense )
+    : output_( std::move( output ) ), backend_( backend )
+  {}
   // 构造函数接受一个 右值引用的 ByteStream 对象（即一个临时的、可移动的流）。
   // 使用 std::move(output) 表示你要把外部的流资源“夺过来”（而不是拷贝一份）。
 
@@ -65,6 +88,14 @@ public:
   // This function is for testing only; don't add extra state to support it.
   uint64_t count_bytes_pending() const;
 
+  Backend backend() const { return backend_; }
+
+  // 暂存着、还不能推出去的区间 [begin, end)，按位置从小到大，最多 max_count 个（TCPReceiver 用来生成 SACK）
+  std::vector<std::pair<uint64_t, uint64_t>> pending_intervals( size_t max_count ) const;
+
+  // 在线扩大输出流的容量（接收缓冲区自动调整用）；Dense 模式会把暂存的数据按新的环大小重新摆放
+  void grow_capacity( uint64_t capacity );
+
   // Access output stream reader
   Reader& reader() { return output_.reader(); }
   const Reader& reader() const { return output_.reader(); }
@@ -73,10 +104,20 @@ public:
   const Writer& writer() const { return output_.writer(); }
 
 private:
+  void insert_dense( uint64_t first_index, std::string data );
+  void insert_interval( uint64_t first_index, std::string data );
+
+  // Dense 模式的环形缓冲区按绝对下标 % 环大小 存放，下面的下标都是绝对下标
+  uint64_t find_dense( uint64_t begin, uint64_t end, bool value ) const; // [begin, end) 中第一个等于 value 的位置
+  void mark_dense( uint64_t begin, uint64_t end, bool value );         // 把 [begin, end) 设置为 value
+  uint64_t count_dense( uint64_t begin, uint64_t end ) const;           // [begin, end) 中暂存了多少字节
+  void flush_dense();                                                  // 把接在前缀后面的暂存数据推出去
+
   ByteStream output_; // 这是 Reassembler 最重要的内部成员：最终要把拼好的数据写到这个流里去。
   uint64_t eof_len_ = -1;
-  uint64_t pending_bytes_ {};
-  std::vector<char> buffer_ {};
-  // std::vector<bool> is_inserted_ {};
-  DynamicBitset is_inserted_ { 0 };
+  std::vector<char> buffer_ {};    // Dense 模式：大小等于流容量的环形缓冲区，第一次 insert 时分配
+  DynamicBitset is_inserted_ { 0 }; // 和 buffer_ 对应的环形 bitset，推出去的位会清零
+  uint64_t pending_bytes_ {};       // Dense 模式暂存的字节数，为 0 时按序到达的数据完全不碰 bitset
+  Backend backend_;
+  std::map<uint64_t, std::string> intervals_ {}; // IntervalMap 模式：起点 -> 数据，区间之间既不重叠也不相邻
 };
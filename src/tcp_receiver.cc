@@ -1,8 +1,10 @@
 #include "tcp_receiver.hh"
 #include "debug.hh"
+#include "tcp_config.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
 #include "wrapping_integers.hh"
+#include <algorithm>
 #include <cstdint>
 #include <iostream>
 #include <sys/types.h>
@@ -38,6 +40,14 @@ void TCPReceiver::receive( TCPSenderMessage message )
     }
     isn_ = message.seqno;
     checkpoint_ = 0;
+    send_sack_ = sack_ && message.sack_permitted;
+    peer_mss_ = message.mss;
+    send_timestamps_ = timestamps_ && message.timestamp.has_value();
+    ts_recent_ = message.timestamp.value_or( 0 );
+    if ( window_scale_.has_value() && message.window_scale.has_value() ) {
+      window_shift_ = *window_scale_;
+      peer_window_scale_ = min( *message.window_scale, TCPConfig::MAX_WINDOW_SCALE ); // RFC 7323：超过 14 按 14 算
+    }
   }
 
   /*
@@ -51,6 +61,21 @@ void TCPReceiver::receive( TCPSenderMessage message )
   */
   uint64_t abs_seq = message.seqno.unwrap( isn_.value(), checkpoint_ );
 
+  /*
+  PAWS（RFC 7323）：高速链路上 32 位序号几秒就回绕一圈，上一圈迟到的旧段 unwrap 之后会落进当前窗口。
+  时间戳是单调的，TSval 比 TS.Recent 旧的段一定是旧段，直接丢弃（对端照常回一个 ack）。
+  只有没有越过上一个发出去的 ackno（Last.ACK.sent）的段才更新 TS.Recent：乱序先到的段不会让回显的时间提前，
+  延迟确认攒着的几个段回显的是其中最早那个的时间，对端算出的 RTT 里包含了 ack 被推迟的时间。
+  */
+  if ( send_timestamps_ && message.timestamp.has_value() ) {
+    if ( static_cast<int32_t>( *message.timestamp - ts_recent_ ) < 0 ) {
+      return;
+    }
+    if ( abs_seq <= last_ack_sent_ ) {
+      ts_recent_ = *message.timestamp;
+    }
+  }
+
   // 若不是 SYN，数据在流中的起始索引应当为 abs_seq - 1
   uint64_t stream_idx = message.SYN ? abs_seq : abs_seq - 1;
 
@@ -58,7 +83,11 @@ void TCPReceiver::receive( TCPSenderMessage message )
   TCP 可能会乱序到达，需要“重组”这些数据，保证应用层接收到的是连续有序的数据。
   重组器的职责是将不同 segment 的数据按照正确的位置插入，处理乱序与重传问题，并识别 FIN 的到达（结束标志）。
   */
-  reassembler_.insert( stream_idx, message.payload, message.FIN );
+  if ( !message.payload.empty() ) {
+    last_segment_begin_ = stream_idx;
+    last_segment_end_ = stream_idx + message.payload.size();
+  }
+  reassembler_.insert( stream_idx, move( message.payload ), message.FIN ); // move：按序到达时 payload 直接进入输出流
 
   /*
   在 TCP 中，接收端需要知道从流起始处到目前为止的连续正确接收的数据长度，从而确定下一个期望的字节序号。
@@ -66,6 +95,13 @@ void TCPReceiver::receive( TCPSenderMessage message )
   checkpoint_ = reassembler_.reader().bytes_popped() + reassembler_.reader().bytes_buffered();
 }
 
+void TCPReceiver::ack_sent( Wrap32 ackno )
+{
+  if ( isn_.has_value() ) {
+    last_ack_sent_ = ackno.unwrap( isn_.value(), checkpoint_ );
+  }
+}
+
 TCPReceiverMessage TCPReceiver::send() const
 {
   // Your code here.
@@ -85,10 +121,33 @@ TCPReceiverMessage TCPReceiver::send() const
 
     // 将绝对序号转换为 Wrap32 类型的 ackno（基于初始序号 isn_）
     msg.ackno = Wrap32::wrap( next_expected_byte, isn_.value() );
+
+    if ( send_timestamps_ ) {
+      msg.timestamp_echo = ts_recent_;
+    }
+
+    // SACK：乱序暂存的区间，流下标加上 SYN 占的 1 就是绝对序号
+    if ( send_sack_ ) {
+      // 时间戳选项占了 12 字节，剩下的地方只够 3 个 SACK 块
+      const size_t max_blocks = send_timestamps_ ? TCPReceiverMessage::MAX_SACK_BLOCKS_WITH_TIMESTAMPS
+                                                 : TCPReceiverMessage::MAX_SACK_BLOCKS;
+      auto intervals = reassembler_.pending_intervals( SIZE_MAX );
+      // RFC 2018：第一个块必须是包含最近收到的那个段的区间，其余的按位置从小到大跟在后面
+      const auto latest = find_if( intervals.begin(), intervals.end(), [&]( const auto& interval ) {
+        return interval.first < last_segment_end_ && last_segment_begin_ < interval.second;
+      } );
+      if ( latest != intervals.end() ) {
+        rotate( intervals.begin(), latest, latest + 1 );
+      }
+      intervals.resize( min( intervals.size(), max_blocks ) );
+      for ( const auto& [begin, end] : intervals ) {
+        msg.sack.push_back( { Wrap32::wrap( begin + 1, isn_.value() ), Wrap32::wrap( end + 1, isn_.value() ) } );
+      }
+    }
   }
 
-  // 限制窗口大小不超过 65535
-  uint64_t avail = reassembler_.writer().available_capacity();
+  // 协商了窗口扩大时按位数缩小，再限制窗口大小不超过 65535
+  uint64_t avail = reassembler_.writer().available_capacity() >> window_shift_;
   msg.window_size = avail > 65535 ? 65535 : static_cast<uint16_t>( avail );
 
   if ( reassembler_.reader().has_error() ) {
@@ -5,6 +5,7 @@
 #include "tcp_sender_message.hh"
 #include "wrapping_integers.hh"
 #include <cstdint>
+#include <optional>
 
 class TCPReceiver
 {
@@ -12,7 +13,15 @@ public:
   // Construct with given Reassembler
 
   // 传入reassemr move夺取对象生命 减少开销
-  explicit TCPReceiver( Reassembler&& reassembler ) : reassembler_( std::move( reassembler ) ) {}
+  // sack 为 true 时，如果对端的 SYN 带了 SACK-permitted，就在 ack 里附上乱序收到的区间
+  // window_scale 是本端 SYN 上通告的窗口扩大位数；对端的 SYN 也带了这个选项时，通告的窗口右移这么多位
+  // timestamps 为 true 时，如果对端的 SYN 带了时间戳，就回显对端的 TSval，并丢弃时间戳倒退的旧段（PAWS）
+  explicit TCPReceiver( Reassembler&& reassembler,
+                        bool sack = false,
+                        std::optional<uint8_t> window_scale = {},
+                        bool timestamps = false )
+    : reassembler_( std::move( reassembler ) ), sack_( sack ), window_scale_( window_scale ), timestamps_( timestamps )
+  {}
 
   /*
    * The TCPReceiver receives TCPSenderMessages, inserting their payload into the Reassembler
@@ -27,14 +36,41 @@ public:
   // 发给对端一个TCP消息
   TCPReceiverMessage send() const;
 
+  // send() 生成的 ackno 真的发出去了（RFC 7323 的 Last.ACK.sent，延迟确认时会落后于 send() 的 ackno）
+  void ack_sent( Wrap32 ackno );
+
   // Access the output
   const Reassembler& reassembler() const { return reassembler_; }
   Reader& reader() { return reassembler_.reader(); }
   const Reader& reader() const { return reassembler_.reader(); }
   const Writer& writer() const { return reassembler_.writer(); }
 
+  // 接收缓冲区自动调整：在线扩大流的容量，之后通告的窗口跟着变大
+  void grow_capacity( uint64_t capacity ) { reassembler_.grow_capacity( capacity ); }
+
+  // 对端 SYN 上的窗口扩大位数（双方都支持时才有值），发送方用它还原对端通告的窗口
+  std::optional<uint8_t> peer_window_scale() const { return peer_window_scale_; }
+
+  // 对端 SYN 上的 MSS 选项，没带时为空
+  std::optional<uint16_t> peer_mss() const { return peer_mss_; }
+
+  // 双方的 SYN 都带了时间戳选项，之后每个段都要带上
+  bool timestamps_negotiated() const { return send_timestamps_; }
+
 private:
   Reassembler reassembler_;
   std::optional<Wrap32> isn_ {}; // 存储收到的 ISN（Initial Sequence Number）
   uint64_t checkpoint_ {};       // 记录最近的流位置（用于 unwrap）
+  bool sack_ {};                 // 本端支持 SACK
+  bool send_sack_ {};            // 双方都支持 SACK，ack 里附上 SACK 块
+  std::optional<uint8_t> window_scale_ {};      // 本端通告的窗口扩大位数
+  uint8_t window_shift_ {};                     // 协商成功后通告窗口右移的位数
+  std::optional<uint8_t> peer_window_scale_ {}; // 对端通告的窗口扩大位数
+  std::optional<uint16_t> peer_mss_ {};         // 对端通告的 MSS
+  bool timestamps_ {};                          // 本端支持时间戳选项
+  bool send_timestamps_ {};                     // 双方都支持时间戳，做 PAWS 检查并回显 TSval
+  uint32_t ts_recent_ {};                       // 要回显的 TSval（RFC 7323 的 TS.Recent）
+  uint64_t last_ack_sent_ {};                   // 最近一次发出去的 ackno（绝对序号）
+  uint64_t last_segment_begin_ {};              // 最近收到的带数据的段在流里的区间 [begin, end)，
+  uint64_t last_segment_end_ {};                // SACK 的第一个块要包含它（RFC 2018）
 };
@@ -3,8 +3,11 @@
 #include "tcp_config.hh"
 #include "tcp_sender_message.hh"
 #include "wrapping_integers.hh"
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <iostream>
+#include <string_view>
 
 using namespace std;
 
@@ -20,67 +23,296 @@ uint64_t TCPSender::consecutive_retransmissions() const
   return consecutive_retransmissions_;
 }
 
+void TCPSender::stamp( TCPSenderMessage& msg ) const
+{
+  if ( send_timestamps_ || ( msg.SYN && timestamps_ ) ) {
+    msg.timestamp = static_cast<uint32_t>( clock_ms_ ); // 1 ms 一跳，RFC 7323 要求在 1 ms 到 1 s 之间
+  }
+  // 段大小按协商出的 MSS 算，链路的 MTU 可能更大
+  if ( msg.payload.size() > segment_payload() ) {
+    msg.gso_size = static_cast<uint16_t>( segment_payload() );
+  }
+}
+
+void TCPSender::track( const TCPSenderMessage& msg )
+{
+  bool app_limited = unsent_bytes() == 0 && sequence_numbers_in_flight_ < send_window();
+  not_ackownledge_.push_back( { .seqno = msg.seqno.unwrap( isn_, last_ackno_ ),
+                                .length = msg.payload.size(),
+                                .transmit_time = current_time_,
+                                .sent_ms = clock_ms_,
+                                .delivered = delivered_,
+                                .delivered_ms = delivered_ms_,
+                                .syn = msg.SYN,
+                                .fin = msg.FIN,
+                                .rst = msg.RST,
+                                .retransmitted = false,
+                                .app_limited = app_limited } );
+}
+
+TCPSenderMessage TCPSender::make_message( const Outstanding& seg ) const
+{
+  TCPSenderMessage msg {};
+  msg.seqno = Wrap32::wrap( seg.seqno, isn_ );
+  msg.SYN = seg.syn;
+  msg.FIN = seg.fin;
+  msg.RST = seg.rst;
+  if ( seg.syn ) {
+    msg.sack_permitted = sack_;
+    msg.window_scale = window_scale_;
+    msg.mss = advertised_mss_;
+  }
+  // 负载第一个字节在流中的下标：SYN 占了序号 0
+  const uint64_t index = seg.seqno + seg.syn - 1;
+  msg.payload = peek_payload( index, seg.length );
+  stamp( msg );
+  return msg;
+}
+
+string TCPSender::peek_payload( uint64_t index, uint64_t len ) const
+{
+  string payload;
+  payload.reserve( len );
+  uint64_t skip = index - input_.reader().bytes_popped();
+  // 环形缓冲区里可能分成两段：跳过前面 skip 个字节，剩下的拼起来
+  for ( string_view region : input_.reader().peek_regions( skip + len ) ) {
+    const uint64_t n = min<uint64_t>( skip, region.size() );
+    region.remove_prefix( n );
+    skip -= n;
+    payload.append( region );
+  }
+  return payload;
+}
+
+uint64_t TCPSender::pacing_rate() const
+{
+  if ( congestion_control_ && congestion_control_->pacing_rate() > 0 ) {
+    return congestion_control_->pacing_rate(); // 基于模型的算法（BBR）自己给出速率
+  }
+  if ( !pacing_ ) {
+    return 0;
+  }
+  if ( configured_pacing_rate_ > 0 ) {
+    return configured_pacing_rate_;
+  }
+  if ( srtt_ms_ == 0 ) {
+    return 0; // 还没有 RTT 样本，没法估计
+  }
+  // 和 Linux 一样：慢启动时按两倍窗口/RTT，之后留 20% 余量，让窗口仍然是主要的限制
+  const double gain = congestion_control_ && congestion_control_->in_slow_start() ? 2.0 : 1.2;
+  return static_cast<uint64_t>( gain * static_cast<double>( send_window() ) * 1000 / srtt_ms_ );
+}
+
+optional<uint64_t> TCPSender::next_send_ms() const
+{
+  const uint64_t rate = pacing_rate();
+  if ( rate == 0 || pacing_budget_ > 0 || unsent_bytes() == 0 || next_seq_ - last_ackno_ >= send_window() ) {
+    return {}; // 没有被 pacing 压住的段
+  }
+  const auto needed = static_cast<uint64_t>( 1 - pacing_budget_ );
+  return max<uint64_t>( ( needed * 1000 + rate - 1 ) / rate, 1 );
+}
+
+void TCPSender::update_rto( uint64_t rtt_ms )
+{
+  const auto r = static_cast<double>( rtt_ms );
+  if ( srtt_ms_ == 0 ) {
+    srtt_ms_ = r; // 第一个样本
+    rttvar_ms_ = r / 2;
+  } else {
+    rttvar_ms_ = 0.75 * rttvar_ms_ + 0.25 * abs( srtt_ms_ - r );
+    srtt_ms_ = 0.875 * srtt_ms_ + 0.125 * r;
+  }
+  if ( !adaptive_rto_ ) {
+    return; // 只估计 RTT（给 pacing 或接收缓冲区自动调整用），RTO 保持固定
+  }
+  const auto rto = static_cast<uint64_t>( ceil( srtt_ms_ + max( 1.0, 4 * rttvar_ms_ ) ) ); // 时钟粒度 1 ms
+  rto_ms_ = clamp( rto, min_rto_ms_, max_rto_ms_ );
+}
+
+void TCPSender::on_duplicate_ack()
+{
+  // 对端每收到一个越过空洞的段才回一个重复 ack。重复 ack 比第一个未确认段后面发出的段还多时，
+  // 是 ack 本身重复或者乱序了，不是丢包的信号（和 Linux 的 tcp_limit_reno_sacked 一样）
+  const uint64_t beyond = next_seq_ - not_ackownledge_.front().end();
+  const uint64_t segments_beyond = ( beyond + segment_payload() - 1 ) / segment_payload();
+  if ( !in_recovery_ && dupacks_ >= segments_beyond ) {
+    return;
+  }
+  dupacks_++;
+  if ( in_recovery_ ) {
+    if ( congestion_control_ ) {
+      congestion_control_->on_dupack();
+    }
+    retransmit_hole_ = true; // 有 SACK 时，每个重复 ack 都可以补一个空洞
+    return;
+  }
+  // 上一次恢复（或超时）之前发出的数据还没全部确认时，这些重复 ack 可能还是那次丢包留下的，不再减一次窗口
+  const bool new_loss = last_ackno_ >= recover_ || !recovers_on_partial_ack();
+  if ( dupacks_ == DUPACK_THRESHOLD && new_loss ) {
+    in_recovery_ = true;
+    recover_ = next_seq_;
+    if ( congestion_control_ ) {
+      congestion_control_->on_fast_retransmit( sequence_numbers_in_flight_, clock_ms_ );
+    }
+    start_loss_recovery();
+    retransmit_hole_ = true;
+  }
+}
+
+bool TCPSender::recovers_on_partial_ack() const
+{
+  return !congestion_control_ || congestion_control_->recovers_on_partial_ack();
+}
+
+void TCPSender::start_loss_recovery()
+{
+  for ( auto& seg : not_ackownledge_ ) {
+    seg.recovery_retransmitted = false;
+  }
+}
+
+void TCPSender::update_scoreboard( const vector<SackBlock>& sack )
+{
+  for ( const auto& block : sack ) {
+    const uint64_t begin = block.begin.unwrap( isn_, last_ackno_ );
+    const uint64_t end = block.end.unwrap( isn_, last_ackno_ );
+    if ( begin < last_ackno_ || end > next_seq_ || begin >= end ) {
+      continue; // 过时或者不合法的块
+    }
+    highest_sacked_ = max( highest_sacked_, end );
+    for ( auto& seg : not_ackownledge_ ) {
+      if ( seg.seqno >= end ) {
+        break;
+      }
+      if ( seg.seqno >= begin && seg.end() <= end ) {
+        seg.sacked = true;
+      }
+    }
+  }
+}
+
+TCPSender::Outstanding* TCPSender::next_hole()
+{
+  for ( auto& seg : not_ackownledge_ ) {
+    if ( &seg != &not_ackownledge_.front() && seg.seqno >= highest_sacked_ ) {
+      break; // 后面的段没有被 SACK 越过，可能还在路上
+    }
+    if ( !seg.sacked && !seg.recovery_retransmitted ) {
+      return &seg;
+    }
+  }
+  return nullptr;
+}
+
+void TCPSender::set_peer_mss( uint16_t peer_mss )
+{
+  mss_ = min<uint64_t>( advertised_mss_.value_or( TCPConfig::MAX_PAYLOAD_SIZE ), max<uint16_t>( peer_mss, 1 ) );
+  if ( congestion_control_ ) {
+    congestion_control_->set_mss( mss_ );
+  }
+}
+
+bool TCPSender::hold_small_segment( uint64_t transmit_size ) const
+{
+  if ( transmit_size >= segment_payload() || is_rst_ ) {
+    return false;
+  }
+  // 流已经关了、这是最后一段：直接发，不用等
+  if ( input_.writer().is_closed() && transmit_size == unsent_bytes() ) {
+    return false;
+  }
+  return corked_ || ( nagle_ && sequence_numbers_in_flight_ > 0 );
+}
+
+uint64_t TCPSender::send_window() const
+{
+  uint64_t window = current_window_size_ > 0 ? current_window_size_ : 1;
+  if ( congestion_control_ ) {
+    window = min( window, congestion_control_->cwnd() );
+  }
+  return window;
+}
+
 void TCPSender::push( const TransmitFunction& transmit )
 {
   if ( input_.has_error() ) {
     is_rst_ = true;
   }
-  uint16_t effictive_window_size = current_window_size_ > 0 ? current_window_size_ : 1;
+  uint64_t effictive_window_size = send_window();
+
+  // 快速重传不受窗口和 pacing 限制，每次最多一个段
+  if ( retransmit_hole_ ) {
+    retransmit_hole_ = false;
+    if ( Outstanding* hole = next_hole() ) {
+      hole->transmit_time = current_time_;
+      hole->sent_ms = clock_ms_;
+      hole->retransmitted = true;
+      hole->recovery_retransmitted = true;
+      transmit( make_message( *hole ) );
+    }
+  }
 
   if ( !is_syn_ ) {
     TCPSenderMessage msg {};
     msg.RST = is_rst_;
     msg.seqno = msg.seqno.wrap( next_seq_, isn_ );
     msg.SYN = true;
+    msg.sack_permitted = sack_;
+    msg.window_scale = window_scale_;
+    msg.mss = advertised_mss_;
     is_syn_ = true;
     uint64_t unacknowledged_message = next_seq_ - last_ackno_;
     if ( effictive_window_size - unacknowledged_message > 1 ) {
-      uint64_t transmit_size = min<uint64_t>( { TCPConfig::MAX_PAYLOAD_SIZE,
-                                                effictive_window_size - unacknowledged_message - 1,
-                                                input_.reader().bytes_buffered() } );
+      uint64_t transmit_size = min<uint64_t>(
+        { max_payload(), effictive_window_size - unacknowledged_message - 1, unsent_bytes() } );
       if ( transmit_size ) {
-        string data = string( input_.reader().peek().substr( 0, transmit_size ) );
-        input_.reader().pop( transmit_size );
-        msg.payload = move( data );
+        msg.payload = peek_payload( sent_index_, transmit_size );
+        sent_index_ += transmit_size;
         next_seq_ += transmit_size;
       }
     }
     sequence_numbers_in_flight_ += msg.payload.size();
     next_seq_++;
     sequence_numbers_in_flight_++;
-    if ( input_.reader().is_finished() ) {
+    if ( input_exhausted() ) {
       msg.FIN = true;
       is_fin_ = true;
       next_seq_++;
       sequence_numbers_in_flight_++;
     }
-    not_ackownledge_.push( { msg, current_time_ } );
+    track( msg );
+    stamp( msg );
     transmit( msg );
-  } else if ( input_.reader().is_finished() && effictive_window_size > ( next_seq_ - last_ackno_ ) && !is_fin_ ) {
+  } else if ( input_exhausted() && effictive_window_size > ( next_seq_ - last_ackno_ ) && !is_fin_ ) {
     TCPSenderMessage msg {};
     msg.RST = is_rst_;
     msg.seqno = msg.seqno.wrap( next_seq_, isn_ );
     is_fin_ = true;
     msg.FIN = true;
+    stamp( msg );
     transmit( msg );
     next_seq_++;
-    not_ackownledge_.push( { msg, current_time_ } );
+    track( msg );
     sequence_numbers_in_flight_++;
   }
 
   while ( true ) {
-    if ( input_.reader().bytes_buffered() == 0 ) {
+    if ( unsent_bytes() == 0 || ( pacing_rate() > 0 && pacing_budget_ <= 0 ) ) {
       return;
     }
     TCPSenderMessage msg {};
     uint64_t unacknowledged_message = next_seq_ - last_ackno_;
-    uint64_t transmit_size = min<uint64_t>( { TCPConfig::MAX_PAYLOAD_SIZE,
-                                              effictive_window_size - unacknowledged_message,
-                                              input_.reader().bytes_buffered() } );
+    // cwnd 缩小后在途数据可能超过窗口，此时不能再发
+    uint64_t window_left
+      = effictive_window_size > unacknowledged_message ? effictive_window_size - unacknowledged_message : 0;
+    uint64_t transmit_size = min<uint64_t>( { max_payload(), window_left, unsent_bytes() } );
+    if ( hold_small_segment( transmit_size ) ) {
+      return; // 等 ack（Nagle）或 uncork 之后再和后面的数据一起发
+    }
     if ( transmit_size ) {
-      string data = string( input_.reader().peek().substr( 0, transmit_size ) );
-      input_.reader().pop( transmit_size );
-      msg.payload = move( data );
+      msg.payload = peek_payload( sent_index_, transmit_size ); // 只拷贝，不 pop：确认之前重传还要用
+      sent_index_ += transmit_size;
     } else {
       return;
     }
@@ -91,15 +323,19 @@ void TCPSender::push( const TransmitFunction& transmit )
     }
     msg.seqno = msg.seqno.wrap( next_seq_, isn_ );
     next_seq_ += transmit_size;
-    if ( effictive_window_size - unacknowledged_message > transmit_size && input_.reader().is_finished() ) {
+    if ( window_left > transmit_size && input_exhausted() ) {
       msg.FIN = true;
       is_fin_ = true;
       next_seq_++;
       sequence_numbers_in_flight_++;
     }
 
-    not_ackownledge_.push( { msg, current_time_ } );
+    track( msg );
     sequence_numbers_in_flight_ += msg.payload.size();
+    if ( pacing_rate() > 0 ) {
+      pacing_budget_ -= static_cast<int64_t>( msg.payload.size() );
+    }
+    stamp( msg );
     transmit( move( msg ) );
     if ( is_break ) {
       break;
@@ -114,10 +350,11 @@ TCPSenderMessage TCPSender::make_empty_message() const
   if ( is_rst_ || input_.has_error() ) {
     msg.RST = true;
   }
+  stamp( msg );
   return msg;
 }
 
-void TCPSender::receive( const TCPReceiverMessage& msg )
+void TCPSender::receive( const TCPReceiverMessage& msg, bool occupies_seqno )
 {
   if ( input_.has_error() ) {
     is_rst_ = true;
@@ -126,51 +363,155 @@ void TCPSender::receive( const TCPReceiverMessage& msg )
   if ( is_rst_ ) {
     input_.set_error();
   }
-  if ( msg.ackno.has_value() && msg.ackno->unwrap( isn_, last_ackno_ ) > next_seq_ ) {
-    return;
+  // 确认了还没发出的序号，或者比已经确认到的位置还旧（乱序到达的老 ack）：都不理会。
+  // 老 ack 不能把 last_ackno_ 往回拉，否则后面再来的同一个老 ack 会被当成重复 ack
+  if ( msg.ackno.has_value() ) {
+    const uint64_t ackno = msg.ackno->unwrap( isn_, last_ackno_ );
+    if ( ackno > next_seq_ || ackno < last_ackno_ ) {
+      return;
+    }
+  }
+  const uint64_t window_size = static_cast<uint64_t>( msg.window_size ) << window_shift_;
+  // 重复 ack：段里不带数据（也没有 SYN/FIN），没有推进确认号、窗口也没变，而且还有数据在途（RFC 5681）。
+  // 双向传输时对端的数据段上捎带的 ack 常常一样，不能算作重复 ack
+  const bool duplicate = !occupies_seqno && msg.ackno.has_value() && !not_ackownledge_.empty()
+                         && msg.ackno->unwrap( isn_, last_ackno_ ) == last_ackno_
+                         && window_size == current_window_size_;
+  current_window_size_ = window_size;
+  if ( duplicate ) {
+    on_duplicate_ack();
   }
-  current_window_size_ = msg.window_size;
   if ( msg.ackno.has_value() ) {
-    last_ackno_ = msg.ackno->unwrap( isn_, last_ackno_ );
+    const uint64_t ackno = msg.ackno->unwrap( isn_, last_ackno_ );
+    if ( ackno > last_ackno_ ) {
+      dupacks_ = 0; // 确认号前进了（哪怕只确认了半个段），重复 ack 重新计数
+    }
+    last_ackno_ = ackno;
     bool acked_new = false;
+    uint64_t acked = 0;
+    Outstanding newest {};     // 这次确认的段里最后发出的那个，用来做速率和 RTT 采样
+    bool acked_retransmitted {}; // 这次确认覆盖了重传过的段
 
-    while ( not_ackownledge_.size()
-            && last_ackno_ >= not_ackownledge_.front().first.seqno.unwrap( isn_, last_ackno_ )
-                                + not_ackownledge_.front().first.sequence_length() ) {
-      sequence_numbers_in_flight_ -= not_ackownledge_.front().first.sequence_length();
-      not_ackownledge_.pop();
+    while ( not_ackownledge_.size() && last_ackno_ >= not_ackownledge_.front().end() ) {
+      sequence_numbers_in_flight_ -= not_ackownledge_.front().sequence_length();
+      acked += not_ackownledge_.front().length; // SYN/FIN 不计入拥塞窗口的增长
+      acked_retransmitted |= not_ackownledge_.front().retransmitted;
+      newest = not_ackownledge_.front();
+      not_ackownledge_.pop_front();
       acked_new = true;
     }
+    reader().pop( acked ); // 累计确认了的字节不会再重传，这时才从流里去掉
+    if ( sack_ ) {
+      update_scoreboard( msg.sack );
+    }
 
     // 如果 ack 了新数据
     if ( acked_new ) {
-      current_ROT_ms_ = initial_RTO_ms_;
+      delivered_ += acked;
+      delivered_ms_ = clock_ms_;
+      // Karn：确认里包含重传过的段时，分不清是哪一次发送被确认的，后面的段也在等这个空洞，都不采样。
+      // 有时间戳时不用猜：回显的 TSval 就是对端收到的那一次发送的时间，重传过的段也能采样
+      uint64_t rtt_ms = acked_retransmitted ? 0 : max<uint64_t>( clock_ms_ - newest.sent_ms, 1 );
+      if ( send_timestamps_ && msg.timestamp_echo.has_value() ) {
+        const uint32_t elapsed = static_cast<uint32_t>( clock_ms_ ) - *msg.timestamp_echo;
+        if ( elapsed <= clock_ms_ ) { // 回显的不是本端发出过的时间，不采样
+          rtt_ms = max<uint64_t>( elapsed, 1 );
+        }
+      }
+      if ( measure_rtt_ && rtt_ms > 0 ) {
+        update_rto( rtt_ms );
+      }
+      if ( congestion_control_ && acked > 0 ) {
+        RateSample sample { .delivered = delivered_, .prior_delivered = newest.delivered };
+        const uint64_t interval_ms = max<uint64_t>( clock_ms_ - newest.delivered_ms, 1 );
+        sample.delivery_rate = ( delivered_ - newest.delivered ) * 1000 / interval_ms;
+        sample.rtt_ms = rtt_ms;
+        sample.is_app_limited = newest.app_limited;
+        congestion_control_->on_rate_sample( sample, clock_ms_ );
+      }
+      dupacks_ = 0;
+      if ( in_recovery_ ) {
+        if ( last_ackno_ >= recover_ || !recovers_on_partial_ack() ) {
+          in_recovery_ = false;
+          if ( congestion_control_ ) {
+            congestion_control_->on_recovery_exit( sequence_numbers_in_flight_, clock_ms_ );
+          }
+        } else {
+          // 部分确认：下一个空洞也丢了，马上重传，不用再等三个重复 ack
+          if ( congestion_control_ ) {
+            congestion_control_->on_partial_ack( acked, sequence_numbers_in_flight_, clock_ms_ );
+          }
+          retransmit_hole_ = true;
+        }
+      } else if ( congestion_control_ && acked > 0 ) {
+        congestion_control_->on_ack( acked, sequence_numbers_in_flight_, clock_ms_ );
+      }
+      current_ROT_ms_ = rto_ms_;
       current_time_ = 0;
       consecutive_retransmissions_ = 0;
 
       // 重新设置第一个未 ack 的 segment 的发送时间为 0
       if ( !not_ackownledge_.empty() ) {
-        not_ackownledge_.front().second = 0;
+        not_ackownledge_.front().transmit_time = 0;
       }
     }
+
+    // 超时之后还没恢复完：SACK 标出来的空洞随 ack 逐个重传，不用每个都再等一次超时
+    if ( !in_recovery_ && last_ackno_ < recover_ && highest_sacked_ > last_ackno_ ) {
+      retransmit_hole_ = true;
+    }
+  }
+  if ( send_capacity_max_ > 0 ) {
+    autosize_send_buffer();
+  }
+}
+
+void TCPSender::autosize_send_buffer()
+{
+  // 窗口（cwnd 或对端窗口）就是一个 RTT 能发出去的量，也就是 带宽 × RTT。
+  // 在途的一窗数据确认之前还占着流，再留一个窗口给应用写，ack 一到就有整窗数据可发（和 Linux 一样取两倍）
+  const uint64_t target = min( 2 * send_window(), send_capacity_max_ );
+  if ( target > send_buffer_size() ) {
+    input_.writer().grow_capacity( target );
   }
 }
 
 void TCPSender::tick( uint64_t ms_since_last_tick, const TransmitFunction& transmit )
 {
   if ( current_ROT_ms_ == 0 ) {
-    current_ROT_ms_ = initial_RTO_ms_;
+    current_ROT_ms_ = rto_ms_;
   }
   current_time_ += ms_since_last_tick;
+  clock_ms_ += ms_since_last_tick;
+  if ( uint64_t rate = pacing_rate() ) {
+    // 每次 tick 按速率补充额度，攒下的额度不超过一次 tick 的量（至少两个段），避免突发
+    auto gained = static_cast<int64_t>( rate * ms_since_last_tick / 1000 );
+    pacing_budget_ = min( pacing_budget_ + gained, max<int64_t>( gained, 2 * max_payload() ) );
+  }
   if ( not_ackownledge_.size() ) {
-    auto& [data, transmit_time] = not_ackownledge_.front();
-    if ( current_time_ - transmit_time >= current_ROT_ms_ ) {
-      transmit_time = current_time_;
-      transmit( move( data ) );
+    auto& front = not_ackownledge_.front();
+    if ( current_time_ - front.transmit_time >= current_ROT_ms_ ) {
+      if ( current_window_size_ > 0 ) { // 零窗口探测不算丢包
+        if ( congestion_control_ ) {
+          congestion_control_->on_timeout( sequence_numbers_in_flight_, clock_ms_ );
+        }
+        in_recovery_ = false;
+        dupacks_ = 0;
+        recover_ = next_seq_;
+        start_loss_recovery();
+      }
+      front.transmit_time = current_time_;
+      front.sent_ms = clock_ms_;
+      front.retransmitted = true;
+      front.recovery_retransmitted = true;
+      transmit( make_message( front ) );
       consecutive_retransmissions_++;
       if ( current_window_size_ > 0 ) {
-        current_ROT_ms_ *= 2;
+        current_ROT_ms_ = min( current_ROT_ms_ * 2, max( max_rto_ms_, rto_ms_ ) ); // 退避不超过上限
       }
     }
   }
+  if ( pacing_rate() > 0 ) {
+    push( transmit ); // 放出被 pacing 压住的段
+  }
 }
\ No newline at end of file
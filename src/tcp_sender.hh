@@ -1,27 +1,63 @@
 #pragma once
 
 #include "byte_stream.hh"
+#include "congestion_control.hh"
 #include "tcp_config.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
 
+#include <algorithm>
 #include <cstdint>
+#include <deque>
 #include <functional>
-#include <queue>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 class TCPSender
 {
 public:
   /* Construct TCP sender with given default Retransmission Timeout and possible ISN */
   TCPSender( ByteStream&& input, Wrap32 isn, uint64_t initial_RTO_ms )
-    : input_( std::move( input ) ), isn_( isn ), initial_RTO_ms_( initial_RTO_ms )
+    : input_( std::move( input ) ), isn_( isn ), initial_RTO_ms_( initial_RTO_ms ), rto_ms_( initial_RTO_ms )
   {}
 
+  /* Construct TCP sender from a TCPConfig (ISN, RTO, congestion control, SACK, window scale, MSS, timestamps) */
+  TCPSender( ByteStream&& input, const TCPConfig& cfg ) : TCPSender( std::move( input ), cfg.isn, cfg.rt_timeout )
+  {
+    if ( cfg.mss.has_value() ) {
+      advertised_mss_ = cfg.mss;
+      mss_ = *cfg.mss;
+    }
+    gso_segments_ = std::max<uint64_t>( cfg.gso_segments, 1 );
+    if ( cfg.pacing ) {
+      pacing_ = true;
+      configured_pacing_rate_ = cfg.pacing_rate;
+      pacing_budget_ = static_cast<int64_t>( 2 * max_payload() ); // 开始时允许两个段
+    }
+    nagle_ = cfg.nagle;
+    measure_rtt_ = cfg.adaptive_rto || cfg.pacing || cfg.recv_autotune;
+    if ( cfg.send_autotune ) {
+      send_capacity_max_ = cfg.send_capacity_max;
+    }
+    congestion_control_ = make_congestion_control( cfg.congestion, mss_ );
+    sack_ = cfg.sack;
+    window_scale_ = cfg.window_scale();
+    timestamps_ = cfg.timestamps;
+    if ( cfg.adaptive_rto ) {
+      adaptive_rto_ = true;
+      min_rto_ms_ = cfg.min_rto_ms;
+      max_rto_ms_ = cfg.max_rto_ms;
+    }
+  }
+
   /* Generate an empty TCPSenderMessage */
   TCPSenderMessage make_empty_message() const;
 
-  /* Receive and process a TCPReceiverMessage from the peer's receiver */
-  void receive( const TCPReceiverMessage& msg );
+  /* Receive and process a TCPReceiverMessage from the peer's receiver. `occupies_seqno` says the segment it came
+     on also carried data, SYN or FIN: such an ack is never counted as a duplicate (RFC 5681). */
+  void receive( const TCPReceiverMessage& msg, bool occupies_seqno = false );
 
   /* Type of the `transmit` function that the push and tick methods can use to send messages */
   using TransmitFunction = std::function<void( const TCPSenderMessage& )>;
@@ -39,14 +75,143 @@ public:
   const Reader& reader() const { return input_.reader(); }
   Writer& writer() { return input_.writer(); }
 
+  // Has the FIN gone out? (The outbound stream only finishes once every byte is acknowledged.)
+  bool fin_sent() const { return is_fin_; }
+
+  // RTT estimate (0 before the first sample) and the retransmission timeout it yields, before any back-off
+  uint64_t srtt_ms() const { return static_cast<uint64_t>( srtt_ms_ ); }
+  uint64_t rto_ms() const { return rto_ms_; }
+
+  // Window scaling (RFC 7323): the shift from the peer's SYN, applied to every later window it advertises
+  void set_window_scale( uint8_t shift ) { window_shift_ = shift; }
+
+  // MSS option from the peer's SYN: segments are sized to the smaller of it and the MSS this side advertised
+  // (MAX_PAYLOAD_SIZE if none)
+  void set_peer_mss( uint16_t peer_mss );
+  uint64_t mss() const { return mss_; }
+
+  // Timestamps (RFC 7323): offered on the SYN if configured. Once the peer's SYN carried the option too, every
+  // segment is stamped, and the echoed TSval gives an RTT sample even for retransmitted segments.
+  void enable_timestamps() { send_timestamps_ = timestamps_; }
+  bool timestamps_enabled() const { return send_timestamps_; }
+
+  // Largest payload in one segment: the MSS less the options every segment carries (RFC 6691), so a full
+  // segment with its timestamp option still fits in the MSS the link allows
+  uint64_t segment_payload() const
+  {
+    return send_timestamps_ && mss_ > TIMESTAMP_OPTION_LENGTH ? mss_ - TIMESTAMP_OPTION_LENGTH : mss_;
+  }
+
+  // Largest payload in one message: one segment's worth, or several for the adapter to split (GSO)
+  uint64_t max_payload() const { return segment_payload() * gso_segments_; }
+
+  // Pacing: the current rate in bytes/s (0 if not pacing), and how long until a held-back segment may go out
+  uint64_t pacing_rate() const;
+  std::optional<uint64_t> next_send_ms() const;
+
+  // Nagle's algorithm (RFC 896): hold back a sub-MSS segment while earlier data is unacknowledged.
+  // nodelay turns it off for latency-sensitive flows, like TCP_NODELAY.
+  void set_nodelay( bool nodelay ) { nagle_ = not nodelay; }
+  bool nodelay() const { return not nagle_; }
+
+  // Corking, like TCP_CORK: hold back sub-MSS segments until uncork() or the stream is closed.
+  // Call push() after uncork() to send what was held.
+  void cork() { corked_ = true; }
+  void uncork() { corked_ = false; }
+  bool corked() const { return corked_; }
+
+  // Size of the outbound stream, in bytes: send_capacity, grown toward send_capacity_max with the window if
+  // send_autotune is set. Data in flight stays in the stream (and counts against it) until acknowledged.
+  uint64_t send_buffer_size() const
+  {
+    return input_.writer().available_capacity() + input_.reader().bytes_buffered();
+  }
+
+  // Congestion control state, or nullptr if the sender is only limited by the peer's window
+  const CongestionControl* congestion_control() const { return congestion_control_.get(); }
+
 private:
   Reader& reader() { return input_.reader(); }
 
+  // Nagle / cork：这个不足一个 MSS 的段要不要先攒着
+  bool hold_small_segment( uint64_t transmit_size ) const;
+
+  // 发送缓冲区自动调整：把流的容量扩大到一个窗口（不超过 send_capacity_max_）
+  void autosize_send_buffer();
+
+  // 发送窗口：对端窗口（为 0 时按 1 探测），有拥塞控制时再和 cwnd 取最小
+  uint64_t send_window() const;
+
+  // 一个已经发出、还没被确认的段。负载不在这里：确认之前还留在 input_ 里，重传时按下标从流里切出来
+  struct Outstanding
+  {
+    uint64_t seqno;         // 第一个序号（绝对序号，不用每次 ack 都 unwrap）
+    uint64_t length;        // 负载字节数
+    uint64_t transmit_time; // 重传计时的起点（和 current_time_ 同一个时钟）
+    uint64_t sent_ms;       // 最后一次发出的时间（clock_ms_）
+    uint64_t delivered;     // 发出时已经确认的字节数，用来算投递速率
+    uint64_t delivered_ms;  // 发出时最后一次确认的时间
+    bool syn;
+    bool fin;
+    bool rst;
+    bool retransmitted;     // 重传过的段不做 RTT 采样（Karn）
+    bool app_limited;       // 发出时应用没有更多数据，速率样本偏低
+    bool sacked {};         // 对端已经用 SACK 确认收到
+    bool recovery_retransmitted {}; // 本轮丢包恢复中已经重传过，不再重复重传
+
+    uint64_t sequence_length() const { return syn + length + fin; }
+    uint64_t end() const { return seqno + sequence_length(); } // 确认号到这里，整个段就确认了
+  };
+
+  // 时间戳选项：SYN 上表示支持，协商成功后每个段都带上当前时钟。
+  // 超过一个段的消息再标上段大小，适配器按它切分（GSO）
+  void stamp( TCPSenderMessage& msg ) const;
+
+  // 记录一个刚发出的段
+  void track( const TCPSenderMessage& msg );
+
+  // 按记录重新组装一个段（重传用）
+  TCPSenderMessage make_message( const Outstanding& seg ) const;
+
+  // 流里还没发出去的字节数（发出去的字节确认之前也留在流里，所以不能直接用 bytes_buffered）
+  uint64_t unsent_bytes() const { return input_.writer().bytes_pushed() - sent_index_; }
+
+  // 流已经关闭而且每个字节都发出去了，可以发 FIN
+  bool input_exhausted() const { return input_.writer().is_closed() && unsent_bytes() == 0; }
+
+  // 从流里拷出下标 [index, index + len) 的字节，不 pop：发出的字节等累计确认以后才从流里 pop 掉
+  std::string peek_payload( uint64_t index, uint64_t len ) const;
+
+  // RFC 6298：用一个 RTT 样本更新 SRTT/RTTVAR；自适应 RTO 时重新计算 RTO
+  void update_rto( uint64_t rtt_ms );
+
+  // 收到重复 ack：计数，到阈值时快速重传并进入快速恢复
+  void on_duplicate_ack();
+
+  // 用 SACK 块标记已经被对端收到的段
+  void update_scoreboard( const std::vector<SackBlock>& sack );
+
+  // 下一个该重传的段：第一个未确认的段，或者被 SACK 越过的空洞；本轮恢复里已经重传过的跳过
+  Outstanding* next_hole();
+
+  // 部分确认时是否留在快速恢复里（没有拥塞控制时按 NewReno，继续补下一个空洞）
+  bool recovers_on_partial_ack() const;
+
+  // 开始新一轮丢包恢复：之前的重传标记作废
+  void start_loss_recovery();
+
+  // 重复 ack 到这个数就认为第一个未确认的段丢了（RFC 5681）
+  static constexpr uint64_t DUPACK_THRESHOLD = 3;
+
+  // 时间戳选项在每个段里占的字节数（NOP, NOP, kind, length, TSval, TSecr）
+  static constexpr uint64_t TIMESTAMP_OPTION_LENGTH = 12;
+
   ByteStream input_;
   Wrap32 isn_;
   uint64_t initial_RTO_ms_;
+  uint64_t rto_ms_; // 不含指数退避的 RTO：自适应模式下由 RTT 估计得出，否则就是初始值
   uint64_t current_ROT_ms_ {};
-  uint16_t current_window_size_ = 1;
+  uint64_t current_window_size_ = 1; // 对端通告的窗口，已经按窗口扩大位数还原
   uint64_t next_seq_ {};
   uint64_t last_ackno_ {};
   uint64_t current_time_ {};
@@ -55,5 +220,35 @@ private:
   bool is_syn_ {};
   bool is_fin_ {};
   bool is_rst_ {};
-  std::queue<std::pair<TCPSenderMessage, int>> not_ackownledge_ {};
+  std::deque<Outstanding> not_ackownledge_ {};
+  uint64_t sent_index_ {}; // 下一个要发出的字节在流中的下标；它之前、bytes_popped 之后的字节在途未确认
+  std::unique_ptr<CongestionControl> congestion_control_ {};
+  uint64_t clock_ms_ {};      // 单调时钟，不随重传计时器清零
+  uint64_t delivered_ {};     // 一共被确认的字节数
+  uint64_t delivered_ms_ {};  // 最后一次有字节被确认的时间
+  int64_t pacing_budget_ {};  // pacing 模式下还能发多少字节，发完一个段可以短暂为负
+  bool pacing_ {};                    // 不依赖拥塞控制算法，也按速率发送
+  uint64_t configured_pacing_rate_ {}; // 配置的 pacing 速率，0 表示按 cwnd / SRTT 估计
+  bool nagle_ {};                      // 有未确认数据时不发不足一个 MSS 的段
+  bool corked_ {};                     // 应用要求先攒数据，uncork 之前只发满 MSS 的段
+  uint64_t send_capacity_max_ {};      // 发送缓冲区自动调整的上限，0 表示不调整
+  bool adaptive_rto_ {};
+  bool measure_rtt_ {}; // 自适应 RTO、pacing 和接收缓冲区自动调整都要用 SRTT
+  uint64_t min_rto_ms_ {};
+  uint64_t max_rto_ms_ = UINT64_MAX;
+  double srtt_ms_ {};
+  double rttvar_ms_ {};
+  uint64_t dupacks_ {};      // 连续收到的重复 ack 个数
+  bool in_recovery_ {};      // 是否在快速恢复中
+  uint64_t recover_ {};      // 进入快速恢复（或超时）时的 next_seq_，确认到这里才算恢复完（RFC 6582）
+  bool retransmit_hole_ {};  // 下次 push 时先重传一个空洞（见 next_hole）
+  bool sack_ {};             // 在 SYN 上声明支持 SACK，并使用对端发来的 SACK 块
+  uint64_t highest_sacked_ {}; // SACK 块覆盖到的最高序号，低于它且没被 SACK 的段认为已经丢失
+  std::optional<uint8_t> window_scale_ {}; // 本端 SYN 上的窗口扩大选项
+  bool timestamps_ {};                     // 在 SYN 上声明支持时间戳选项
+  bool send_timestamps_ {};                // 双方都支持时间戳，每个段都带 TSval，用回显采样 RTT
+  uint8_t window_shift_ {};                // 对端通告的窗口要左移的位数
+  std::optional<uint16_t> advertised_mss_ {};          // 本端 SYN 上的 MSS 选项
+  uint64_t mss_ = TCPConfig::MAX_PAYLOAD_SIZE;         // 每个段最多带多少字节负载
+  uint64_t gso_segments_ = 1;                          // 每个消息最多带几个 MSS
 };
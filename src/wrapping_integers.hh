@@ -19,10 +19,10 @@ Wrap32 类型表示的是一个 32 位无符号整数，它有以下两个特点
 class Wrap32
 {
 public:
-  explicit Wrap32( uint32_t raw_value ) : raw_value_( raw_value ) {}
+  explicit constexpr Wrap32( uint32_t raw_value ) : raw_value_( raw_value ) {}
 
   /* Construct a Wrap32 given an absolute sequence number n and the zero point. */
-  static Wrap32 wrap( uint64_t n, Wrap32 zero_point );
+  static constexpr Wrap32 wrap( uint64_t n, Wrap32 zero_point ) { return zero_point + n; }
 
   /*
    * The unwrap method returns an absolute sequence number that wraps to this Wrap32, given the zero point
@@ -33,15 +33,25 @@ public:
    */
   // unwrap 的主要任务就是找出最接近 checkpoint 的那一个绝对序列号，使得当使用相应的 wrap 方法转换后，能够得到当前的
   // Wrap32 值。
-  uint64_t unwrap( Wrap32 zero_point, uint64_t checkpoint ) const;
+  constexpr uint64_t unwrap( Wrap32 zero_point, uint64_t checkpoint ) const
+  {
+    // 目标值与 checkpoint 低 32 位之差按有符号 32 位解释，落在 [-2^31, 2^31) 内，checkpoint + delta 即最近的候选
+    const uint32_t offset = raw_value_ - zero_point.raw_value_;
+    const int64_t delta = static_cast<int32_t>( offset - static_cast<uint32_t>( checkpoint ) );
+    const uint64_t ans = checkpoint + static_cast<uint64_t>( delta );
+    // 越过 0 或 2^64 回绕时，改取相邻一圈（距离仍不超过 2^32）；用比较结果做掩码，不引入分支
+    const uint64_t underflow = static_cast<uint64_t>( delta < 0 ) & static_cast<uint64_t>( ans > checkpoint );
+    const uint64_t overflow = static_cast<uint64_t>( delta > 0 ) & static_cast<uint64_t>( ans < checkpoint );
+    return ans + ( underflow << 32 ) - ( overflow << 32 );
+  }
 
   // 该运算符重载允许你将一个 32 位无符号整数 n 与一个 Wrap32 对象相加。具体来说，它将当前对象内部存储的原始值
   // raw_value_ 与 n 相加，并构造一个新的 Wrap32 对象返回。这样做的目的是实现 Wrap32 值的递增操作
-  Wrap32 operator+( uint32_t n ) const { return Wrap32 { raw_value_ + n }; }
+  constexpr Wrap32 operator+( uint32_t n ) const { return Wrap32 { raw_value_ + n }; }
 
   // 运算符重载用于比较两个 Wrap32 对象是否相等。它通过比较每个对象内部的 raw_value_
   //  是否相同来判断两个对象是否代表相同的 32 位数值。
-  bool operator==( const Wrap32& other ) const { return raw_value_ == other.raw_value_; }
+  constexpr bool operator==( const Wrap32& other ) const { return raw_value_ == other.raw_value_; }
 
 protected:
   uint32_t raw_value_ {};
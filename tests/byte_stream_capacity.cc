@@ -96,6 +96,30 @@ int main()
       test.execute( BytesBuffered { 1 } );
     }
 
+    for ( const auto storage :
+          { ByteStream::Storage::Contiguous, ByteStream::Storage::Ring, ByteStream::Storage::Chunked } ) {
+      ByteStreamTestHarness test { "grow capacity while data is buffered", 4, storage };
+
+      test.execute( Push { "abcd" } );
+      test.execute( Pop { 3 } );
+      test.execute( Push { "efgh" } ); // wraps around a ring
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( GrowCapacity { 2 } ); // never shrinks
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( GrowCapacity { 8 } );
+      test.execute( AvailableCapacity { 4 } );
+      test.execute( BytesBuffered { 4 } );
+      test.execute( Peek { "defg" } );
+      test.execute( Push { "hijklm" } );
+      test.execute( BytesPushed { 11 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( Peek { "defghijk" } );
+      test.execute( Pop { 6 } );
+      test.execute( Push { "lmnopq" } );
+      test.execute( Close {} );
+      test.execute( ReadAll { "jklmnopq" } );
+      test.execute( IsFinished { true } );
+    }
   } catch ( const exception& e ) {
     cerr << "Exception: " << e.what() << "\n";
     return EXIT_FAILURE;
@@ -0,0 +1,66 @@
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ByteStreamTestHarness test { "chunked: peek returns the front chunk", 15, ByteStream::Storage::Chunked };
+
+      test.execute( Push { "cat" } );
+      test.execute( Push { "" } );
+      test.execute( Push { "tac" } );
+      test.execute( BytesBuffered { 6 } );
+      test.execute( PeekOnce { "cat" } );
+      test.execute( Pop { 1 } );
+      test.execute( PeekOnce { "at" } );
+      test.execute( Pop { 3 } );
+      test.execute( PeekOnce { "ac" } );
+      test.execute( Peek { "ac" } );
+      test.execute( AvailableCapacity { 13 } );
+    }
+
+    {
+      ByteStreamTestHarness test { "chunked: push is trimmed to capacity", 5, ByteStream::Storage::Chunked };
+
+      test.execute( Push { "abc" } );
+      test.execute( Push { "defg" } );
+      test.execute( BytesPushed { 5 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( Peek { "abcde" } );
+      test.execute( Pop { 5 } );
+      test.execute( BufferEmpty { true } );
+      test.execute( Push { "hij" } );
+      test.execute( Close {} );
+      test.execute( ReadAll { "hij" } );
+      test.execute( IsFinished { true } );
+      test.execute( BytesPopped { 8 } );
+    }
+
+    {
+      ByteStreamTestHarness test { "chunked: pop across several chunks", 100, ByteStream::Storage::Chunked };
+
+      test.execute( Push { "a" } );
+      test.execute( Push { "bc" } );
+      test.execute( Push { "def" } );
+      test.execute( PeekRegions { { "a", "bc", "def" } } );
+      test.execute( Pop { 1 } );
+      test.execute( PeekRegions { { "bc", "d" }, 3 } );
+      test.execute( Pop { 3 } );
+      test.execute( PeekOnce { "ef" } );
+      test.execute( PeekRegions { { "ef" } } );
+      test.execute( Pop { 10 } );
+      test.execute( BufferEmpty { true } );
+      test.execute( BytesPopped { 6 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
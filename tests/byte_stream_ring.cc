@@ -0,0 +1,89 @@
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ByteStreamTestHarness test { "ring: peek stops at the end of the ring", 4, ByteStream::Storage::Ring };
+
+      test.execute( Push { "abc" } );
+      test.execute( Pop { 2 } );
+      test.execute( Push { "def" } );
+      test.execute( BytesBuffered { 4 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( PeekOnce { "cd" } );
+      test.execute( Peek { "cdef" } );
+      test.execute( PeekRegions { { "cd", "ef" } } );
+      test.execute( PeekRegions { { "cd", "e" }, 3 } );
+      test.execute( PeekRegions { { "c" }, 1 } );
+      test.execute( Pop { 2 } );
+      test.execute( PeekOnce { "ef" } );
+      test.execute( PeekRegions { { "ef" } } );
+    }
+
+    {
+      ByteStreamTestHarness test { "ring: wrap many times", 3, ByteStream::Storage::Ring };
+
+      test.execute( Push { "abcd" } );
+      test.execute( BytesPushed { 3 } );
+      test.execute( ReadAll { "abc" } );
+      test.execute( Push { "de" } );
+      test.execute( Push { "fg" } );
+      test.execute( BytesPushed { 6 } );
+      test.execute( ReadAll { "def" } );
+      test.execute( Push { "ghij" } );
+      test.execute( Pop { 1 } );
+      test.execute( Push { "jk" } );
+      test.execute( Peek { "hij" } );
+      test.execute( Close {} );
+      test.execute( ReadAll { "hij" } );
+      test.execute( IsFinished { true } );
+      test.execute( BytesPopped { 10 } );
+    }
+
+    {
+      ByteStreamTestHarness test { "ring: write in place", 5, ByteStream::Storage::Ring };
+
+      test.execute( PushInPlace { "abc" } );
+      test.execute( BytesPushed { 3 } );
+      test.execute( Pop { 2 } );
+      test.execute( PushInPlace { "defgh" } );
+      test.execute( BytesPushed { 7 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( PeekRegions { { "cde", "fg" } } );
+      test.execute( Close {} );
+      test.execute( PushInPlace { "x" } );
+      test.execute( ReadAll { "cdefg" } );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      ByteStreamTestHarness test { "contiguous: no regions to write in place", 5 };
+
+      test.execute( PushInPlace { "abc" } );
+      test.execute( BytesPushed { 0 } );
+      test.execute( Push { "abc" } );
+      test.execute( ReadAll { "abc" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "ring: zero capacity", 0, ByteStream::Storage::Ring };
+
+      test.execute( Push { "cat" } );
+      test.execute( BytesPushed { 0 } );
+      test.execute( BufferEmpty { true } );
+      test.execute( Close {} );
+      test.execute( IsFinished { true } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
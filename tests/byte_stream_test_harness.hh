@@ -5,6 +5,7 @@
 #include "helpers.hh"
 
 #include <utility>
+#include <vector>
 
 static_assert( sizeof( Reader ) == sizeof( ByteStream ),
                "Please add member variables to the ByteStream base, not the ByteStream Reader." );
@@ -19,6 +20,25 @@ public:
     : TestHarness( move( test_name ), "capacity=" + std::to_string( capacity ), ByteStream { capacity } )
   {}
 
+  ByteStreamTestHarness( std::string test_name, uint64_t capacity, ByteStream::Storage storage )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity ) + ", storage=" + storage_name( storage ),
+                   ByteStream { capacity, storage } )
+  {}
+
+  static std::string storage_name( ByteStream::Storage storage )
+  {
+    switch ( storage ) {
+      case ByteStream::Storage::Contiguous:
+        return "contiguous";
+      case ByteStream::Storage::Ring:
+        return "ring";
+      case ByteStream::Storage::Chunked:
+        return "chunked";
+    }
+    return "unknown";
+  }
+
   size_t peek_size() { return object().reader().peek().size(); }
 };
 
@@ -34,6 +54,38 @@ struct Push : public Action<ByteStream>
   constexpr std::string obj() const override { return "Writer"; }
 };
 
+struct PushInPlace : public Action<ByteStream>
+{
+  std::string data_;
+
+  explicit PushInPlace( std::string data ) : data_( move( data ) ) {}
+  std::string description() const override
+  {
+    return "write \"" + pretty_print( data_ ) + "\" into writable_regions() and commit";
+  }
+  void execute( ByteStream& bs ) const override
+  {
+    uint64_t written = 0;
+    for ( auto region : bs.writer().writable_regions() ) {
+      const auto len = std::min<uint64_t>( region.size(), data_.size() - written );
+      data_.copy( region.data(), len, written );
+      written += len;
+    }
+    bs.writer().commit( written );
+  }
+  constexpr std::string obj() const override { return "Writer"; }
+};
+
+struct GrowCapacity : public Action<ByteStream>
+{
+  uint64_t capacity_;
+
+  explicit GrowCapacity( uint64_t capacity ) : capacity_( capacity ) {}
+  std::string description() const override { return "grow_capacity( " + std::to_string( capacity_ ) + " )"; }
+  void execute( ByteStream& bs ) const override { bs.writer().grow_capacity( capacity_ ); }
+  constexpr std::string obj() const override { return "Writer"; }
+};
+
 struct Close : public Action<ByteStream>
 {
   std::string description() const override { return "close"; }
@@ -119,6 +171,47 @@ struct PeekOnce : public Peek
   }
 };
 
+struct PeekRegions : public Expectation<ByteStream>
+{
+  std::vector<std::string> output_;
+  uint64_t max_len_;
+
+  explicit PeekRegions( std::vector<std::string> output, uint64_t max_len = UINT64_MAX )
+    : output_( move( output ) ), max_len_( max_len )
+  {}
+
+  std::string description() const override
+  {
+    std::string desc = "peek_regions(";
+    if ( max_len_ != UINT64_MAX ) {
+      desc += " " + std::to_string( max_len_ ) + " ";
+    }
+    desc += ") gives {";
+    for ( const auto& x : output_ ) {
+      desc += " \"" + pretty_print( x ) + "\"";
+    }
+    return desc + " }";
+  }
+
+  void execute( const ByteStream& bs ) const override
+  {
+    auto regions = bs.reader().peek_regions( max_len_ );
+    if ( regions.size() != output_.size() ) {
+      throw ExpectationViolation { "peek_regions() should have returned " + std::to_string( output_.size() )
+                                   + " regions, but returned " + std::to_string( regions.size() ) };
+    }
+    for ( size_t i = 0; i < regions.size(); i++ ) {
+      if ( regions[i] != output_[i] ) {
+        throw ExpectationViolation { "peek_regions() region " + std::to_string( i ) + " should have been \""
+                                     + pretty_print( output_[i] ) + "\", but was \"" + pretty_print( regions[i] )
+                                     + "\"" };
+      }
+    }
+  }
+
+  constexpr std::string obj() const override { return "Reader"; }
+};
+
 struct IsClosed : public ExpectBool<ByteStream>
 {
   using ExpectBool::ExpectBool;
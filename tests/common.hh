@@ -25,6 +25,14 @@ public:
   {}
 };
 
+// For tests that check a condition directly instead of through a TestHarness
+inline void expect( bool condition, const std::string& what )
+{
+  if ( not condition ) {
+    throw ExpectationViolation { what };
+  }
+}
+
 template<class T>
 struct TestStep
 {
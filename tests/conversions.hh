@@ -1,11 +1,13 @@
 #pragma once
 
 #include "helpers.hh"
+#include "tcp_receiver_message.hh"
 #include "wrapping_integers.hh"
 
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 // https://stackoverflow.com/questions/33399594/making-a-user-defined-class-stdto-stringable
 
@@ -33,6 +35,15 @@ std::string to_string( const std::optional<T>& v )
   return "None";
 }
 
+inline std::string to_string( const std::vector<SackBlock>& blocks )
+{
+  std::string ret = "[";
+  for ( const auto& block : blocks ) {
+    ret += ( ret.size() > 1 ? ", " : "" ) + to_string( block.begin ) + "-" + to_string( block.end );
+  }
+  return ret + "]";
+}
+
 inline std::string to_string( bool b )
 {
   return b ? "true" : "false";
@@ -248,6 +248,31 @@ int main()
 
       test.execute( IsFinished( true ) );
     }
+
+    for ( const auto backend : { Reassembler::Backend::Dense, Reassembler::Backend::IntervalMap } ) {
+      ReassemblerTestHarness test { "grow capacity with bytes pending", 8, backend };
+
+      test.execute( Insert { "ab", 0 } );
+      test.execute( ReadAll( "ab" ) );
+      test.execute( Insert { "fgh", 5 } );
+      test.execute( Insert { "j", 9 } ); // wraps around a dense ring of 8
+      test.execute( BytesPending( 4 ) );
+
+      test.execute( GrowOutputCapacity { 16 } );
+      test.execute( BytesPending( 4 ) );
+      test.execute( Insert { "mnopq", 12 } ); // beyond the old capacity
+      test.execute( BytesPending( 9 ) );
+
+      test.execute( Insert { "cde", 2 } );
+      test.execute( BytesPushed( 8 ) );
+      test.execute( BytesPending( 6 ) );
+      test.execute( Insert { "i", 8 } );
+      test.execute( BytesPushed( 10 ) );
+      test.execute( Insert { "kl", 10 } );
+      test.execute( BytesPushed( 17 ) );
+      test.execute( BytesPending( 0 ) );
+      test.execute( ReadAll( "cdefghijklmnopq" ) );
+    }
   } catch ( const exception& e ) {
     cerr << "Exception: " << e.what() << "\n";
     return EXIT_FAILURE;
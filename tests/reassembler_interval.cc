@@ -0,0 +1,129 @@
+#include "byte_stream_test_harness.hh"
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <random>
+
+using namespace std;
+
+namespace {
+
+constexpr auto interval_map = Reassembler::Backend::IntervalMap;
+
+// Feed the same random (overlapping, out-of-order, partly out-of-window) substrings
+// to a dense and an interval-map Reassembler, and check they always agree.
+void compare_with_dense( const size_t input_len, // NOLINT(bugprone-easily-swappable-parameters)
+                         const size_t capacity,  // NOLINT(bugprone-easily-swappable-parameters)
+                         const size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  const string data = [&] {
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < input_len; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  Reassembler dense { ByteStream { capacity } };
+  Reassembler intervals { ByteStream { capacity }, interval_map };
+  string dense_output;
+  string intervals_output;
+
+  uniform_int_distribution<size_t> length_dist { 0, 64 };
+  uniform_int_distribution<size_t> pop_dist { 0, capacity };
+  while ( not dense.reader().is_finished() ) {
+    const auto window_start = dense.writer().bytes_pushed();
+    uniform_int_distribution<size_t> index_dist { window_start > 16 ? window_start - 16 : 0,
+                                                  min( data.size(), window_start + capacity + 16 ) };
+    const auto first_index = min( index_dist( rd ), data.size() );
+    const auto substring = data.substr( first_index, length_dist( rd ) );
+    const bool is_last = first_index + substring.size() == data.size();
+    dense.insert( first_index, substring, is_last );
+    intervals.insert( first_index, substring, is_last );
+
+    if ( dense.count_bytes_pending() != intervals.count_bytes_pending() ) {
+      throw runtime_error( "count_bytes_pending() mismatch: dense=" + to_string( dense.count_bytes_pending() )
+                           + ", interval-map=" + to_string( intervals.count_bytes_pending() ) );
+    }
+    if ( dense.pending_intervals( SIZE_MAX ) != intervals.pending_intervals( SIZE_MAX ) ) {
+      throw runtime_error( "pending_intervals() mismatch between dense and interval-map Reassemblers" );
+    }
+    if ( dense.writer().bytes_pushed() != intervals.writer().bytes_pushed()
+         or dense.writer().is_closed() != intervals.writer().is_closed() ) {
+      throw runtime_error( "interval-map Reassembler diverged from dense Reassembler" );
+    }
+
+    const auto to_pop = pop_dist( rd );
+    string got;
+    read( dense.reader(), to_pop, got );
+    dense_output += got;
+    read( intervals.reader(), to_pop, got );
+    intervals_output += got;
+  }
+
+  if ( dense_output != data or intervals_output != data or not intervals.reader().is_finished() ) {
+    throw runtime_error( "interval-map Reassembler produced the wrong stream" );
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    {
+      ReassemblerTestHarness test { "interval map: merge on insert", 65000, interval_map };
+
+      test.execute( Insert { "c", 2 } );
+      test.execute( Insert { "ef", 4 } );
+      test.execute( BytesPending { 3 } );
+      test.execute( Insert { "de", 3 } );
+      test.execute( BytesPending { 4 } );
+      test.execute( Insert { "bcdefg", 1 } );
+      test.execute( BytesPending { 6 } );
+      test.execute( BytesPushed { 0 } );
+      test.execute( Insert { "a", 0 } );
+      test.execute( BytesPending { 0 } );
+      test.execute( ReadAll( "abcdefg" ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "interval map: trim to window", 4, interval_map };
+
+      test.execute( Insert { "bcdef", 1 }.is_last() );
+      test.execute( BytesPending { 3 } );
+      test.execute( Insert { "a", 0 } );
+      test.execute( BytesPending { 0 } );
+      test.execute( ReadAll( "abcd" ) );
+      test.execute( IsFinished { false } );
+      test.execute( Insert { "ef", 4 }.is_last() );
+      test.execute( ReadAll( "ef" ) );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      ReassemblerTestHarness test { "interval map: duplicate and stale data", 8, interval_map };
+
+      test.execute( Insert { "abc", 0 } );
+      test.execute( Insert { "ab", 0 } );
+      test.execute( Insert { "e", 4 } );
+      test.execute( Insert { "e", 4 } );
+      test.execute( BytesPending { 1 } );
+      test.execute( Insert { "bcd", 1 } );
+      test.execute( BytesPending { 0 } );
+      test.execute( ReadAll( "abcde" ) );
+    }
+
+    compare_with_dense( 20000, 100, 4321 );
+    compare_with_dense( 20000, 1000, 1111 );
+    compare_with_dense( 5000, 7, 2222 );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,329 @@
+#include "reassembler.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Count heap allocations made while a scenario runs.
+namespace {
+size_t allocation_count = 0; // NOLINT(*-avoid-non-const-global-variables)
+size_t allocation_bytes = 0; // NOLINT(*-avoid-non-const-global-variables)
+} // namespace
+
+void* operator new( size_t size )
+{
+  ++allocation_count;
+  allocation_bytes += size;
+  if ( void* ptr = malloc( size ) ) { // NOLINT(*-no-malloc)
+    return ptr;
+  }
+  throw bad_alloc {};
+}
+
+void* operator new[]( size_t size )
+{
+  return operator new( size );
+}
+
+void operator delete( void* ptr ) noexcept
+{
+  free( ptr ); // NOLINT(*-no-malloc)
+}
+
+void operator delete[]( void* ptr ) noexcept
+{
+  free( ptr ); // NOLINT(*-no-malloc)
+}
+
+void operator delete( void* ptr, size_t /*unused*/ ) noexcept
+{
+  free( ptr ); // NOLINT(*-no-malloc)
+}
+
+void operator delete[]( void* ptr, size_t /*unused*/ ) noexcept
+{
+  free( ptr ); // NOLINT(*-no-malloc)
+}
+
+namespace {
+
+struct Segment
+{
+  uint64_t first_index;
+  string data;
+  bool is_last;
+};
+
+// Read a "VmXXX:  1234 kB" line from /proc/self/status
+uint64_t proc_status_kib( string_view field )
+{
+  ifstream status { "/proc/self/status" };
+  string line;
+  while ( getline( status, line ) ) {
+    if ( line.starts_with( field ) ) {
+      return stoull( line.substr( field.size() + 1 ) );
+    }
+  }
+  return 0;
+}
+
+// Reset the kernel's peak-RSS watermark so VmHWM reflects only what follows
+void reset_peak_rss()
+{
+  ofstream clear_refs { "/proc/self/clear_refs" };
+  clear_refs << "5";
+}
+
+/*
+ * Every scenario emulates a sender that works through the stream one window
+ * (`capacity` bytes) at a time: it sends the window's segments in some order,
+ * possibly losing, duplicating or overshooting some of them, then retransmits
+ * whatever the receiver has not yet pushed. The reader drains the stream after
+ * every segment, so the whole window is always available.
+ */
+using Sender = function<void( const string& data, uint64_t window_start, uint64_t window_end, vector<Segment>& )>;
+
+void add_segment( const string& data, uint64_t first_index, uint64_t len, vector<Segment>& out )
+{
+  len = min<uint64_t>( len, data.size() - first_index );
+  out.push_back( { first_index, data.substr( first_index, len ), first_index + len == data.size() } );
+}
+
+// Retransmit [from, to) in segments of `mss` bytes
+void retransmit( const string& data, uint64_t from, uint64_t to, uint64_t mss, vector<Segment>& out )
+{
+  for ( uint64_t i = from; i < to; i += mss ) {
+    add_segment( data, i, min( mss, to - i ), out );
+  }
+}
+
+vector<Segment> make_schedule( const string& data, uint64_t capacity, const Sender& send_window )
+{
+  vector<Segment> schedule;
+  for ( uint64_t window_start = 0; window_start < data.size(); window_start += capacity ) {
+    send_window( data, window_start, min<uint64_t>( window_start + capacity, data.size() ), schedule );
+  }
+  return schedule;
+}
+
+constexpr uint64_t MSS = 1000;
+
+Sender in_order()
+{
+  return []( const string& data, uint64_t start, uint64_t end, vector<Segment>& out ) {
+    retransmit( data, start, end, MSS, out );
+  };
+}
+
+// Each segment is lost independently with probability `loss`; losses are resent at the end of the window
+Sender bernoulli_loss( double loss, uint64_t seed )
+{
+  return [loss, rd = make_shared<default_random_engine>( seed )](
+           const string& data, uint64_t start, uint64_t end, vector<Segment>& out ) {
+    bernoulli_distribution lost { loss };
+    vector<uint64_t> holes;
+    for ( uint64_t i = start; i < end; i += MSS ) {
+      if ( lost( *rd ) ) {
+        holes.push_back( i );
+      } else {
+        add_segment( data, i, min( MSS, end - i ), out );
+      }
+    }
+    for ( auto i : holes ) {
+      add_segment( data, i, min( MSS, end - i ), out );
+    }
+  };
+}
+
+// Losses come in bursts of `burst` consecutive segments
+Sender burst_loss( double burst_start, uint64_t burst, uint64_t seed )
+{
+  return [burst_start, burst, rd = make_shared<default_random_engine>( seed )](
+           const string& data, uint64_t start, uint64_t end, vector<Segment>& out ) {
+    bernoulli_distribution starts { burst_start };
+    uint64_t hole_begin = end;
+    uint64_t hole_end = end;
+    for ( uint64_t i = start; i < end; i += MSS ) {
+      if ( hole_begin == end and starts( *rd ) ) {
+        hole_begin = i;
+        hole_end = min( end, i + burst * MSS );
+      }
+      if ( i < hole_begin or i >= hole_end ) {
+        add_segment( data, i, min( MSS, end - i ), out );
+      }
+    }
+    retransmit( data, hole_begin, hole_end, MSS, out );
+  };
+}
+
+// Every segment is followed by two copies shifted back by a random amount
+Sender heavy_overlap( uint64_t seed )
+{
+  return [rd = make_shared<default_random_engine>( seed )](
+           const string& data, uint64_t start, uint64_t end, vector<Segment>& out ) {
+    uniform_int_distribution<uint64_t> shift { 0, MSS };
+    for ( uint64_t i = start; i < end; i += MSS ) {
+      add_segment( data, i, min( MSS, end - i ), out );
+      for ( int copy = 0; copy < 2; ++copy ) {
+        const uint64_t back = min( shift( *rd ), i - start );
+        add_segment( data, i - back, min( MSS, end - ( i - back ) ), out );
+      }
+    }
+  };
+}
+
+// 16-byte segments, with one in ten adjacent pairs swapped
+Sender tiny_segments( uint64_t seed )
+{
+  return [rd = make_shared<default_random_engine>( seed )](
+           const string& data, uint64_t start, uint64_t end, vector<Segment>& out ) {
+    constexpr uint64_t tiny = 16;
+    bernoulli_distribution swap { 0.1 };
+    for ( uint64_t i = start; i < end; i += tiny ) {
+      if ( i + tiny < end and swap( *rd ) ) {
+        add_segment( data, i + tiny, min( tiny, end - i - tiny ), out );
+        add_segment( data, i, tiny, out );
+        i += tiny;
+      } else {
+        add_segment( data, i, min( tiny, end - i ), out );
+      }
+    }
+  };
+}
+
+// Segments are sent out of order and overshoot the end of the window by half an MSS (that part is trimmed)
+Sender window_edge( uint64_t seed )
+{
+  return [rd = make_shared<default_random_engine>( seed )](
+           const string& data, uint64_t start, uint64_t end, vector<Segment>& out ) {
+    vector<uint64_t> starts;
+    for ( uint64_t i = start + MSS / 2; i < end; i += MSS ) {
+      starts.push_back( i );
+    }
+    shuffle( starts.begin(), starts.end(), *rd );
+    for ( auto i : starts ) {
+      add_segment( data, i, MSS, out );
+    }
+    retransmit( data, start, min( end, start + MSS / 2 ), MSS, out );
+  };
+}
+
+void run_scenario( fstream& debug_output,
+                   const string& data,
+                   const uint64_t capacity,
+                   const Reassembler::Backend backend,
+                   string_view scenario,
+                   vector<Segment> schedule ) // a copy: the segments' data is moved into the Reassembler
+{
+  string output_data;
+  output_data.reserve( data.size() );
+
+  const auto rss_before = proc_status_kib( "VmRSS:" );
+  reset_peak_rss();
+  allocation_count = 0;
+  allocation_bytes = 0;
+
+  const auto start_time = steady_clock::now();
+  {
+    Reassembler reassembler { ByteStream { capacity, ByteStream::Storage::Chunked }, backend };
+    for ( auto& seg : schedule ) {
+      reassembler.insert( seg.first_index, move( seg.data ), seg.is_last );
+      while ( reassembler.reader().bytes_buffered() ) {
+        auto view = reassembler.reader().peek();
+        output_data += view;
+        reassembler.reader().pop( view.size() );
+      }
+    }
+    if ( not reassembler.reader().is_finished() ) {
+      throw runtime_error( "Reassembler did not close ByteStream when finished (" + string( scenario ) + ")" );
+    }
+  }
+  const auto stop_time = steady_clock::now();
+
+  const auto allocations = allocation_count;
+  const auto allocated = allocation_bytes;
+  const auto peak_rss = proc_status_kib( "VmHWM:" );
+
+  if ( data != output_data ) {
+    throw runtime_error( "Mismatch between data written and read (" + string( scenario ) + ")" );
+  }
+
+  auto test_duration = duration_cast<duration<double>>( stop_time - start_time );
+  auto gigabits_per_second = 8 * static_cast<double>( data.size() ) / test_duration.count() / 1e9;
+  const string_view backend_name = backend == Reassembler::Backend::Dense ? "dense" : "interval-map";
+
+  cout << "Reassembler (" << backend_name << ", " << scenario << ") with capacity=" << capacity << " reached "
+       << fixed << setprecision( 2 ) << gigabits_per_second << " Gbit/s, peak RSS +"
+       << ( peak_rss > rss_before ? peak_rss - rss_before : 0 ) << " KiB, " << allocations << " allocations ("
+       << allocated / 1024 << " KiB).\n";
+
+  debug_output << "        " << left << setw( 13 ) << backend_name << setw( 15 ) << scenario << right << setw( 8 )
+               << capacity << fixed << setprecision( 2 ) << setw( 8 ) << gigabits_per_second << " Gbit/s"
+               << setw( 8 ) << allocations << " allocs\n";
+
+  if ( gigabits_per_second < 0.1 ) {
+    throw runtime_error( "Reassembler did not meet minimum speed of 0.1 Gbit/s (" + string( scenario ) + ")" );
+  }
+}
+
+void program_body()
+{
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  const string data = [] {
+    default_random_engine rd { 9090 };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < 4'000'000; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  const vector<pair<string_view, Sender>> scenarios {
+    { "in-order", in_order() },
+    { "1% loss", bernoulli_loss( 0.01, 1 ) },
+    { "burst loss", burst_loss( 0.005, 10, 2 ) },
+    { "heavy overlap", heavy_overlap( 3 ) },
+    { "tiny segments", tiny_segments( 4 ) },
+    { "window edge", window_edge( 5 ) },
+  };
+
+  for ( const auto capacity : { 16'384UL, 65'536UL, 1'048'576UL } ) {
+    for ( const auto& [name, sender] : scenarios ) {
+      // One schedule per scenario and capacity, so both backends see exactly the same arrivals
+      const auto schedule = make_schedule( data, capacity, sender );
+      for ( const auto backend : { Reassembler::Backend::Dense, Reassembler::Backend::IntervalMap } ) {
+        run_scenario( debug_output, data, capacity, backend, name, schedule );
+      }
+    }
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
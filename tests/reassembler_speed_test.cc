@@ -17,7 +17,8 @@ void speed_test( const size_t num_chunks,  // NOLINT(bugprone-easily-swappable-p
                  const size_t overlap,     // NOLINT(bugprone-easily-swappable-parameters)
                  const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
                  const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
-                 string_view scenario )
+                 string_view scenario,
+                 const Reassembler::Backend backend = Reassembler::Backend::Dense )
 {
   // Generate the data to be written
   const string data = [&] {
@@ -46,7 +47,7 @@ void speed_test( const size_t num_chunks,  // NOLINT(bugprone-easily-swappable-p
     }
   }
 
-  Reassembler reassembler { ByteStream { capacity } };
+  Reassembler reassembler { ByteStream { capacity }, backend };
 
   string output_data;
   output_data.reserve( data.size() );
@@ -96,6 +97,8 @@ void program_body()
 {
   speed_test( 1000, 1500, 1500, 32768, 1370, "(no overlap):  " );
   speed_test( 1000, 1500, 150, 32768, 6163, "(10x overlap): " );
+  speed_test( 1000, 1500, 1500, 32768, 1370, "(no overlap, interval map):  ", Reassembler::Backend::IntervalMap );
+  speed_test( 1000, 1500, 150, 32768, 6163, "(10x overlap, interval map): ", Reassembler::Backend::IntervalMap );
 }
 
 int main()
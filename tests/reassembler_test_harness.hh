@@ -31,6 +31,13 @@ public:
                    { Reassembler { ByteStream { capacity } } } )
   {}
 
+  ReassemblerTestHarness( std::string test_name, uint64_t capacity, Reassembler::Backend backend )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity ) + ", backend="
+                     + ( backend == Reassembler::Backend::IntervalMap ? "interval-map" : "dense" ),
+                   { Reassembler { ByteStream { capacity }, backend } } )
+  {}
+
   template<std::derived_from<TestStep<ByteStream>> T>
   void execute( const T& test )
   {
@@ -47,6 +54,15 @@ struct BytesPending : public ExpectNumber<Reassembler, uint64_t>
   uint64_t value( const Reassembler& r ) const override { return r.count_bytes_pending(); }
 };
 
+struct GrowOutputCapacity : public Action<Reassembler>
+{
+  uint64_t capacity_;
+
+  explicit GrowOutputCapacity( uint64_t capacity ) : capacity_( capacity ) {}
+  std::string description() const override { return "grow_capacity( " + std::to_string( capacity_ ) + " )"; }
+  void execute( Reassembler& r ) const override { r.grow_capacity( capacity_ ); }
+};
+
 struct Insert : public Action<Reassembler>
 {
   std::string data_;
@@ -7,6 +7,7 @@
 #include <optional>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 template<std::derived_from<TestStep<Reassembler>> T>
 struct DirectReassemblerTest : public TestStep<TCPReceiver>
@@ -37,10 +38,16 @@ struct DirectByteStreamTest : public TestStep<TCPReceiver>
 class TCPReceiverTestHarness : public TestHarness<TCPReceiver>
 {
 public:
-  TCPReceiverTestHarness( std::string test_name, uint64_t capacity )
+  TCPReceiverTestHarness( std::string test_name,
+                          uint64_t capacity,
+                          bool sack = false,
+                          std::optional<uint8_t> window_scale = {},
+                          bool timestamps = false )
     : TestHarness( move( test_name ),
-                   "capacity=" + std::to_string( capacity ),
-                   { TCPReceiver { Reassembler { ByteStream { capacity } } } } )
+                   "capacity=" + std::to_string( capacity ) + ( sack ? ", sack" : "" )
+                     + ( window_scale ? ", wscale=" + std::to_string( *window_scale ) : "" )
+                     + ( timestamps ? ", timestamps" : "" ),
+                   { TCPReceiver { Reassembler { ByteStream { capacity } }, sack, window_scale, timestamps } } )
   {}
 
   template<std::derived_from<TestStep<Reassembler>> T>
@@ -72,6 +79,13 @@ struct ExpectAckno : public ExpectNumber<TCPReceiver, std::optional<Wrap32>>
   std::optional<Wrap32> value( const TCPReceiver& rs ) const override { return rs.send().ackno; }
 };
 
+struct ExpectSack : public ExpectNumber<TCPReceiver, std::vector<SackBlock>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "sack"; }
+  std::vector<SackBlock> value( const TCPReceiver& rs ) const override { return rs.send().sack; }
+};
+
 struct ExpectReset : public ExpectBool<TCPReceiver>
 {
   using ExpectBool::ExpectBool;
@@ -108,6 +122,20 @@ struct ExpectAcknoBetween : public Expectation<TCPReceiver>
   }
 };
 
+struct ExpectPeerWindowScale : public ExpectNumber<TCPReceiver, std::optional<uint8_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "peer_window_scale"; }
+  std::optional<uint8_t> value( const TCPReceiver& rs ) const override { return rs.peer_window_scale(); }
+};
+
+struct ExpectTimestampEcho : public ExpectNumber<TCPReceiver, std::optional<uint32_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "timestamp_echo"; }
+  std::optional<uint32_t> value( const TCPReceiver& rs ) const override { return rs.send().timestamp_echo; }
+};
+
 struct HasAckno : public ExpectBool<TCPReceiver>
 {
   using ExpectBool::ExpectBool;
@@ -138,6 +166,24 @@ struct SegmentArrives : public Action<TCPReceiver>
     return *this;
   }
 
+  SegmentArrives& with_sack_permitted()
+  {
+    msg_.sack_permitted = true;
+    return *this;
+  }
+
+  SegmentArrives& with_window_scale( uint8_t shift )
+  {
+    msg_.window_scale = shift;
+    return *this;
+  }
+
+  SegmentArrives& with_timestamp( uint32_t timestamp )
+  {
+    msg_.timestamp = timestamp;
+    return *this;
+  }
+
   SegmentArrives& with_seqno( Wrap32 seqno_ )
   {
     msg_.seqno = seqno_;
@@ -177,3 +223,15 @@ struct SegmentArrives : public Action<TCPReceiver>
     return ss.str();
   }
 };
+
+struct AckSent : public Action<TCPReceiver>
+{
+  void execute( TCPReceiver& rs ) const override
+  {
+    if ( const auto ackno = rs.send().ackno ) {
+      rs.ack_sent( *ackno );
+    }
+  }
+
+  std::string description() const override { return "transmit the current ackno"; }
+};
@@ -0,0 +1,83 @@
+#include "random.hh"
+#include "receiver_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "SACK blocks report the out-of-order data", 4000, true };
+      test.execute( SegmentArrives {}.with_syn().with_sack_permitted().with_seqno( isn ) );
+      test.execute( ExpectSack { {} } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "efgh" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 1 } } );
+      test.execute( ExpectSack { { { Wrap32 { isn + 5 }, Wrap32 { isn + 9 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 13 ).with_data( "mn" ) );
+      test.execute( ExpectSack {
+        { { Wrap32 { isn + 13 }, Wrap32 { isn + 15 } }, { Wrap32 { isn + 5 }, Wrap32 { isn + 9 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 9 ).with_data( "ij" ) );
+      test.execute( ExpectSack {
+        { { Wrap32 { isn + 5 }, Wrap32 { isn + 11 } }, { Wrap32 { isn + 13 }, Wrap32 { isn + 15 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 11 } } );
+      test.execute( ExpectSack { { { Wrap32 { isn + 13 }, Wrap32 { isn + 15 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 11 ).with_data( "kl" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 15 } } );
+      test.execute( ExpectSack { {} } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "At most MAX_SACK_BLOCKS blocks, most recent first", 4000, true };
+      test.execute( SegmentArrives {}.with_syn().with_sack_permitted().with_seqno( isn ) );
+      for ( uint32_t i = 0; i < 6; i++ ) {
+        test.execute( SegmentArrives {}.with_seqno( isn + 11 + 10 * i ).with_data( "xyz" ) );
+      }
+      test.execute( ExpectSack { { { Wrap32 { isn + 61 }, Wrap32 { isn + 64 } },
+                                   { Wrap32 { isn + 11 }, Wrap32 { isn + 14 } },
+                                   { Wrap32 { isn + 21 }, Wrap32 { isn + 24 } },
+                                   { Wrap32 { isn + 31 }, Wrap32 { isn + 34 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 34 ).with_data( "pq" ) );
+      test.execute( ExpectSack { { { Wrap32 { isn + 31 }, Wrap32 { isn + 36 } },
+                                   { Wrap32 { isn + 11 }, Wrap32 { isn + 14 } },
+                                   { Wrap32 { isn + 21 }, Wrap32 { isn + 24 } },
+                                   { Wrap32 { isn + 41 }, Wrap32 { isn + 44 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcdefghij" ) );
+      test.execute( ExpectSack { { { Wrap32 { isn + 21 }, Wrap32 { isn + 24 } },
+                                   { Wrap32 { isn + 31 }, Wrap32 { isn + 36 } },
+                                   { Wrap32 { isn + 41 }, Wrap32 { isn + 44 } },
+                                   { Wrap32 { isn + 51 }, Wrap32 { isn + 54 } } } } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "No SACK blocks unless the peer's SYN permits them", 4000, true };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "efgh" ) );
+      test.execute( ExpectSack { {} } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "No SACK blocks unless the receiver supports them", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_sack_permitted().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "efgh" ) );
+      test.execute( ExpectSack { {} } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
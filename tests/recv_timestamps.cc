@@ -0,0 +1,124 @@
+#include "byte_stream_test_harness.hh"
+#include "random.hh"
+#include "receiver_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test {
+        "Echoes the peer's TSval once both SYNs carry timestamps", 4000, false, {}, true };
+      test.execute( SegmentArrives {}.with_syn().with_timestamp( 100 ).with_seqno( isn ) );
+      test.execute( AckSent {} );
+      test.execute( ExpectTimestampEcho { 100 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abc" ).with_timestamp( 105 ) );
+      test.execute( AckSent {} );
+      test.execute( ExpectAckno { Wrap32 { isn + 4 } } );
+      test.execute( ExpectTimestampEcho { 105 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 4 ).with_data( "d" ).with_timestamp( 1U << 31 ) );
+      test.execute( AckSent {} );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "e" ).with_timestamp( UINT32_MAX ) );
+      test.execute( AckSent {} );
+      test.execute( SegmentArrives {}.with_seqno( isn + 6 ).with_data( "f" ).with_timestamp( 3 ) ); // clock wrapped
+      test.execute( AckSent {} );
+      test.execute( ExpectAckno { Wrap32 { isn + 7 } } );
+      test.execute( ExpectTimestampEcho { 3 } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test {
+        "PAWS drops an old duplicate whose seqno lands in the window", 4000, false, {}, true };
+      test.execute( SegmentArrives {}.with_syn().with_timestamp( 100 ).with_seqno( isn ) );
+      test.execute( AckSent {} );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abc" ).with_timestamp( 200 ) );
+      test.execute( AckSent {} );
+      test.execute( SegmentArrives {}.with_seqno( isn + 4 ).with_data( "OLD" ).with_timestamp( 150 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 4 } } );
+      test.execute( BytesPushed { 3 } );
+      test.execute( ExpectTimestampEcho { 200 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 4 ).with_data( "def" ).with_timestamp( 200 ) );
+      test.execute( AckSent {} );
+      test.execute( ExpectAckno { Wrap32 { isn + 7 } } );
+      test.execute( BytesPushed { 6 } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "Out-of-order segments don't advance the echo", 4000, false, {}, true };
+      test.execute( SegmentArrives {}.with_syn().with_timestamp( 100 ).with_seqno( isn ) );
+      test.execute( AckSent {} );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "efgh" ).with_timestamp( 300 ) );
+      test.execute( AckSent {} );
+      test.execute( ExpectAckno { Wrap32 { isn + 1 } } );
+      test.execute( ExpectTimestampEcho { 100 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ).with_timestamp( 310 ) );
+      test.execute( AckSent {} );
+      test.execute( ExpectAckno { Wrap32 { isn + 9 } } );
+      test.execute( ExpectTimestampEcho { 310 } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "Delayed acks echo the earliest unacknowledged TSval", 4000, false, {}, true };
+      test.execute( SegmentArrives {}.with_syn().with_timestamp( 100 ).with_seqno( isn ) );
+      test.execute( AckSent {} );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abc" ).with_timestamp( 110 ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 4 ).with_data( "def" ).with_timestamp( 120 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 7 } } );
+      test.execute( ExpectTimestampEcho { 110 } );
+      test.execute( AckSent {} );
+      test.execute( SegmentArrives {}.with_seqno( isn + 7 ).with_data( "g" ).with_timestamp( 130 ) );
+      test.execute( ExpectTimestampEcho { 130 } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test {
+        "No echo and no PAWS unless the peer's SYN has timestamps", 4000, false, {}, true };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectTimestampEcho { {} } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abc" ).with_timestamp( 200 ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 4 ).with_data( "def" ).with_timestamp( 150 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 7 } } );
+      test.execute( ExpectTimestampEcho { {} } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "Peer's timestamps are ignored unless configured", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_timestamp( 100 ).with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abc" ).with_timestamp( 50 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 4 } } );
+      test.execute( ExpectTimestampEcho { {} } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "With timestamps, at most three SACK blocks", 4000, true, {}, true };
+      test.execute( SegmentArrives {}.with_syn().with_sack_permitted().with_timestamp( 7 ).with_seqno( isn ) );
+      for ( uint32_t i = 0; i < 5; i++ ) {
+        test.execute( SegmentArrives {}.with_seqno( isn + 11 + 10 * i ).with_data( "xyz" ).with_timestamp( 8 ) );
+      }
+      test.execute( ExpectSack { { { Wrap32 { isn + 51 }, Wrap32 { isn + 54 } },
+                                   { Wrap32 { isn + 11 }, Wrap32 { isn + 14 } },
+                                   { Wrap32 { isn + 21 }, Wrap32 { isn + 24 } } } } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,58 @@
+#include "random.hh"
+#include "receiver_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "Window is scaled once both SYNs carry the option", 1000000, false, 4 };
+      test.execute( SegmentArrives {}.with_syn().with_window_scale( 7 ).with_seqno( isn ) );
+      test.execute( ExpectPeerWindowScale { 7 } );
+      test.execute( ExpectWindow { 1000000 >> 4 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( string( 16, 'x' ) ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 17 } } );
+      test.execute( ExpectWindow { ( 1000000 - 16 ) >> 4 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 17 ).with_data( "y" ) );
+      test.execute( ExpectWindow { ( 1000000 - 17 ) >> 4 } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "Window is clamped unless the peer offers scaling", 1000000, false, 4 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectPeerWindowScale { {} } );
+      test.execute( ExpectWindow { UINT16_MAX } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "Peer's option is ignored unless scaling is configured", 1000000 };
+      test.execute( SegmentArrives {}.with_syn().with_window_scale( 7 ).with_seqno( isn ) );
+      test.execute( ExpectPeerWindowScale { {} } );
+      test.execute( ExpectWindow { UINT16_MAX } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "Peer's shift is capped at 14", 1000000, false, 4 };
+      test.execute( SegmentArrives {}.with_syn().with_window_scale( 20 ).with_seqno( isn ) );
+      test.execute( ExpectPeerWindowScale { 14 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
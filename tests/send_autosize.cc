@@ -0,0 +1,87 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.send_capacity = 2000;
+
+      TCPSenderTestHarness test { "Send buffer stays fixed without autosizing", cfg };
+      test.execute( ExpectSendBufferSize { 2000 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( ExpectSendBufferSize { 2000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.send_capacity = 2000;
+      cfg.send_autotune = true;
+      cfg.send_capacity_max = 40000;
+
+      TCPSenderTestHarness test { "Send buffer grows to twice the peer's window, up to the ceiling", cfg };
+      test.execute( ExpectSendBufferSize { 2000 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 10000 ) );
+      test.execute( ExpectSendBufferSize { 20000 } );
+      test.execute( Push { string( 12000, 'x' ) } );
+      for ( size_t i = 0; i < 10; i++ ) {
+        test.execute( ExpectMessage {}.with_payload_size( TCPConfig::MAX_PAYLOAD_SIZE ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { isn + 10001 }.with_win( 60000 ) );
+      test.execute( ExpectSendBufferSize { 40000 } );
+      test.execute( AckReceived { isn + 10001 }.with_win( 5000 ) );
+      test.execute( ExpectSendBufferSize { 40000 } ); // never shrinks
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+      cfg.isn = isn;
+      cfg.send_capacity = 2000;
+      cfg.send_autotune = true;
+      cfg.congestion = TCPConfig::Congestion::Reno;
+
+      TCPSenderTestHarness test { "Send buffer follows cwnd as it grows", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 10 * mss } );
+      test.execute( ExpectSendBufferSize { 20 * mss } );
+      test.execute( Push { string( 10 * mss, 'x' ) } );
+      for ( size_t i = 0; i < 10; i++ ) {
+        test.execute( ExpectMessage {}.with_payload_size( mss ) );
+      }
+      for ( uint64_t i = 1; i <= 10; i++ ) {
+        test.execute( AckReceived { isn + 1 + i * mss }.with_win( 60000 ) ); // slow start: one MSS per ack
+      }
+      test.execute( ExpectCongestionWindow { 20 * mss } );
+      test.execute( ExpectSendBufferSize { 40 * mss } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,321 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+    const uint64_t initial_window = CongestionControl::INITIAL_WINDOW * mss;
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "Without congestion control only the receiver window applies", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 30000 ) );
+      test.execute( Push { string( 2 * initial_window, 'x' ) } );
+      for ( uint64_t i = 0; i < 2 * initial_window / mss; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 2 * initial_window } );
+    }
+
+    for ( const auto algorithm : { TCPConfig::Congestion::Reno, TCPConfig::Congestion::NewReno } ) {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion = algorithm;
+
+      TCPSenderTestHarness test { "Initial window, then slow start", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 30000 ) );
+      test.execute( ExpectCongestionWindow { initial_window } );
+      test.execute( Push { string( 2 * initial_window, 'x' ) } );
+      for ( uint64_t i = 0; i < initial_window / mss; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { initial_window } );
+
+      // each ack of a full segment in slow start opens room for two more
+      test.execute( AckReceived { Wrap32 { isn + 1 + mss } }.with_win( 30000 ) );
+      test.execute( ExpectCongestionWindow { initial_window + mss } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { initial_window + mss } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.rt_timeout = 100;
+      cfg.congestion = TCPConfig::Congestion::Reno;
+
+      TCPSenderTestHarness test { "Timeout collapses the window to one segment", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 30000 ) );
+      test.execute( Push { string( 2 * initial_window, 'x' ) } );
+      for ( uint64_t i = 0; i < initial_window / mss; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      }
+      test.execute( Tick { 99 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( isn + 1 ) );
+      test.execute( ExpectCongestionWindow { mss } );
+      test.execute( ExpectSlowStartThreshold { initial_window / 2 } );
+
+      // everything outstanding is acked: slow start resumes from one segment
+      test.execute( AckReceived { Wrap32 { isn + 1 + uint32_t( initial_window ) } }.with_win( 30000 ) );
+      test.execute( ExpectCongestionWindow { 2 * mss } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion = TCPConfig::Congestion::Reno;
+
+      TCPSenderTestHarness test { "The receiver window still applies under congestion control", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 2500 ) );
+      test.execute( Push { string( initial_window, 'x' ) } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 500 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.rt_timeout = 100;
+      cfg.congestion = TCPConfig::Congestion::Cubic;
+
+      TCPSenderTestHarness test { "CUBIC reduces ssthresh by beta on timeout", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 30000 ) );
+      test.execute( Push { string( initial_window, 'x' ) } );
+      for ( uint64_t i = 0; i < initial_window / mss; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      }
+      test.execute( Tick { 100 } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( isn + 1 ) );
+      test.execute( ExpectCongestionWindow { mss } );
+      test.execute( ExpectSlowStartThreshold { initial_window * 7 / 10 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.rt_timeout = 100;
+      cfg.congestion = TCPConfig::Congestion::Reno;
+
+      TCPSenderTestHarness test { "Zero-window probes do not shrink the congestion window", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 0 ) );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "a" ) );
+      test.execute( Tick { 100 } );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "a" ) );
+      test.execute( ExpectCongestionWindow { initial_window } );
+    }
+
+    for ( const auto algorithm : { TCPConfig::Congestion::Reno, TCPConfig::Congestion::NewReno } ) {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion = algorithm;
+
+      TCPSenderTestHarness test { "Three duplicate acks trigger fast retransmit and fast recovery", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 2 * initial_window, 'x' ) } );
+      for ( uint64_t i = 0; i < initial_window / mss; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      }
+
+      // the first segment is lost
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSlowStartThreshold { initial_window / 2 } );
+      test.execute( ExpectCongestionWindow { initial_window / 2 + 3 * mss } );
+
+      // each further duplicate inflates the window by a segment
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { initial_window + mss } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( isn + 1 + initial_window ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+
+      // the retransmission fills the first hole, but the third segment was lost too
+      test.execute( AckReceived { Wrap32 { isn + 1 + uint32_t( 2 * mss ) } }.with_win( 60000 ) );
+      if ( algorithm == TCPConfig::Congestion::NewReno ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( isn + 1 + 2 * mss ) );
+        test.execute( ExpectCongestionWindow { initial_window } );
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+        test.execute( ExpectNoSegment {} );
+
+        // everything sent before recovery is acked: the window deflates
+        test.execute( AckReceived { Wrap32 { isn + 1 + uint32_t( initial_window ) } }.with_win( 60000 ) );
+        test.execute( ExpectCongestionWindow { 3 * mss } );
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+        test.execute( ExpectNoSegment {} );
+      } else {
+        // Reno leaves recovery on the first new ack
+        test.execute( ExpectCongestionWindow { initial_window / 2 } );
+        test.execute( ExpectNoSegment {} );
+      }
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.rt_timeout = 100;
+
+      TCPSenderTestHarness test { "Without congestion control duplicate acks still fast-retransmit", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 4 * mss, 'x' ) } );
+      for ( uint64_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      }
+      for ( uint64_t i = 0; i < 3; ++i ) {
+        test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      }
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 1 + mss } }.with_win( 60000 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( isn + 1 + mss ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion = TCPConfig::Congestion::Reno;
+
+      TCPSenderTestHarness test { "Acks older than the acked point are not duplicate acks", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 4 * mss, 'x' ) } );
+      for ( uint64_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      }
+      test.execute( AckReceived { Wrap32 { isn + 1 + mss } }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { initial_window + mss } );
+      for ( uint64_t i = 0; i < 4; ++i ) {
+        test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectCongestionWindow { initial_window + mss } );
+      test.execute( ExpectSeqnosInFlight { 3 * mss } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "An ack into the middle of a segment restarts the duplicate count", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 4 * mss, 'x' ) } );
+      for ( uint64_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      }
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 + mss / 2 } }.with_win( 60000 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 + mss / 2 } }.with_win( 60000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 1 + mss / 2 } }.with_win( 60000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 1 + mss / 2 } }.with_win( 60000 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_seqno( isn + 1 ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion = TCPConfig::Congestion::BBR;
+
+      TCPSenderTestHarness test { "BBR paces at the measured delivery rate", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( initial_window, 'x' ) } );
+      for ( uint64_t i = 0; i < initial_window / mss; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      }
+
+      // the first window is acked after 100 ms: 100 kB/s, so Startup paces at 2.885 * 100 kB/s
+      test.execute( Tick { 100 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Push { string( 4 * initial_window, 'x' ) } );
+      test.execute( AckReceived { Wrap32 { isn + 1 + uint32_t( initial_window ) } }.with_win( 60000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectCongestionWindow { 2 * initial_window } );
+
+      // 10 ms of budget is 2885 bytes, released as three segments
+      test.execute( Tick { 10 } );
+      for ( int i = 0; i < 3; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      }
+      test.execute( ExpectNoSegment {} );
+
+      // after that, one segment every ~3.5 ms
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 2 } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,137 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "Without Nagle, small writes go out at once", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 10000 ) );
+      test.execute( Push { "a" } );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "a" ).with_seqno( isn + 1 ) );
+      test.execute( Push { "b" } );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "b" ).with_seqno( isn + 2 ) );
+      test.execute( ExpectSeqnosInFlight { 2 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.nagle = true;
+
+      TCPSenderTestHarness test { "Nagle holds small writes until the ack", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 10000 ) );
+      test.execute( Push { "a" } );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "a" ).with_seqno( isn + 1 ) );
+      test.execute( Push { "b" } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Push { "c" } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 1 } );
+      test.execute( AckReceived { isn + 2 }.with_win( 10000 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "bc" ).with_seqno( isn + 2 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { isn + 4 }.with_win( 10000 ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.nagle = true;
+      const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+      TCPSenderTestHarness test { "Nagle still sends full segments, and the tail with the FIN", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 10000 ) );
+      test.execute( Push { "x" } );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "x" ) );
+      test.execute( Push { string( mss + 10, 'y' ) } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( isn + 2 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 1 + mss } );
+      test.execute( Close {} );
+      test.execute( ExpectMessage {}.with_fin( true ).with_payload_size( 10 ).with_seqno( isn + 2 + mss ) );
+      test.execute( ExpectSeqnosInFlight { 1 + mss + 11 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.nagle = true;
+
+      TCPSenderTestHarness test { "Setting nodelay releases held data on the next push", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 10000 ) );
+      test.execute( Push { "a" } );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "a" ) );
+      test.execute( Push { "b" } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( SetNodelay { true } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "b" ).with_seqno( isn + 2 ) );
+      test.execute( Push { "c" } );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "c" ).with_seqno( isn + 3 ) );
+      test.execute( SetNodelay { false } );
+      test.execute( Push { "d" } );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+      TCPSenderTestHarness test { "Cork batches writes until uncork", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 10000 ) );
+      test.execute( Cork {} );
+      test.execute( Push { "hello " } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Push { "world" } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( Uncork {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "hello world" ).with_seqno( isn + 1 ) );
+
+      test.execute( Cork {} );
+      test.execute( Push { string( 2 * mss + 5, 'z' ) } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Close {} );
+      test.execute( ExpectMessage {}.with_fin( true ).with_payload_size( 5 ).with_seqno( isn + 12 + 2 * mss ) );
+      test.execute( HasError { false } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
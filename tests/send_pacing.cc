@@ -0,0 +1,99 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+    const auto seg = []( Wrap32 isn, uint64_t i ) { return isn + 1 + static_cast<uint32_t>( i * mss ); };
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.pacing = true;
+      cfg.pacing_rate = 1'000'000; // one segment per millisecond
+
+      TCPSenderTestHarness test { "Pacing at a configured rate spreads the window out", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( ExpectPacingRate { 1'000'000 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 10 * mss, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( seg( isn, 0 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( seg( isn, 1 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectNextSendMs { 1 } );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( seg( isn, 2 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 3 } );
+      for ( uint64_t i = 3; i < 6; i++ ) {
+        test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( seg( isn, i ) ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 100 } );
+      for ( uint64_t i = 6; i < 10; i++ ) {
+        test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( seg( isn, i ) ) );
+      }
+      test.execute( ExpectNextSendMs { {} } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.pacing = true;
+      cfg.congestion = TCPConfig::Congestion::Reno;
+      const uint64_t cwnd = CongestionControl::INITIAL_WINDOW * mss;
+
+      TCPSenderTestHarness test { "Estimated pacing rate is twice cwnd / SRTT in slow start", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( ExpectPacingRate { 0 } );
+      test.execute( Tick { 10 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ).without_push() );
+      test.execute( ExpectPacingRate { 2 * cwnd * 1000 / 10 } );
+      test.execute( Push { string( 10 * mss, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( seg( isn, 0 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( seg( isn, 1 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectNextSendMs { 1 } );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( seg( isn, 2 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( seg( isn, 3 ) ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.pacing = true;
+      cfg.pacing_rate = 1'000'000;
+
+      TCPSenderTestHarness test { "Nothing to release when the window is full", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 2 * mss ) );
+      test.execute( Push { string( 10 * mss, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( seg( isn, 0 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( seg( isn, 1 ) ) );
+      test.execute( ExpectNextSendMs { {} } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -6,6 +6,7 @@
 #include <exception>
 #include <iostream>
 #include <string>
+#include <vector>
 
 using namespace std;
 
@@ -198,6 +199,69 @@ int main()
       test.execute( ExpectSeqnosInFlight { 0 } );
       test.execute( HasError { false } );
     }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      const uint16_t retx_timeout = uniform_int_distribution<uint16_t> { 10, 10000 }( rd );
+      cfg.isn = isn;
+      cfg.rt_timeout = retx_timeout;
+
+      TCPSenderTestHarness test { "Retx data intact after partial acks", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      vector<string> chunks;
+      for ( size_t i = 0; i < 20; i++ ) {
+        string chunk( 1000, static_cast<char>( 'a' + i ) );
+        chunk.front() = static_cast<char>( 'A' + i );
+        test.execute( Push { chunk } );
+        test.execute( ExpectMessage {}.with_no_flags().with_data( chunk ).with_seqno( isn + 1 + i * 1000 ) );
+        chunks.push_back( move( chunk ) );
+      }
+      test.execute( ExpectSeqnosInFlight { 20000 } );
+
+      // Acked bytes are popped from the outbound stream; the rest must still retransmit byte-for-byte.
+      for ( const size_t acked : { 3, 9, 12, 17 } ) {
+        test.execute( AckReceived { Wrap32 { isn + 1 + acked * 1000 } }.with_win( 60000 ) );
+        test.execute( ExpectSeqnosInFlight { ( 20 - acked ) * 1000 } );
+        test.execute( ExpectNoSegment {} );
+        test.execute( Tick { retx_timeout } );
+        test.execute(
+          ExpectMessage {}.with_no_flags().with_data( chunks[acked] ).with_seqno( isn + 1 + acked * 1000 ) );
+        test.execute( ExpectNoSegment {} );
+      }
+      test.execute( AckReceived { Wrap32 { isn + 20001 } }.with_win( 60000 ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( Push { "tail" } );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "tail" ).with_seqno( isn + 20001 ) );
+      test.execute( Tick { retx_timeout } );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "tail" ).with_seqno( isn + 20001 ) );
+      test.execute( HasError { false } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.send_capacity = 2000;
+
+      TCPSenderTestHarness test { "Unacked data holds its space in the outbound stream", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 2000, 'a' ) } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( Push { "dropped" } ); // the stream is still full of data in flight
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 1001 } }.with_win( 60000 ) );
+      test.execute( Push { "bcd" } );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "bcd" ).with_seqno( isn + 2001 ) );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( string( 1000, 'a' ) ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectSeqnosInFlight { 1003 } );
+    }
   } catch ( const exception& e ) {
     cerr << e.what() << "\n";
     return 1;
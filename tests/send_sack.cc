@@ -0,0 +1,135 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+    const uint64_t initial_window = CongestionControl::INITIAL_WINDOW * mss;
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.sack = true;
+
+      TCPSenderTestHarness test { "SACK-permitted goes out on the SYN", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_sack_permitted( true ).with_seqno( isn ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "No SACK-permitted unless configured", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_sack_permitted( false ).with_seqno( isn ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.sack = true;
+      cfg.congestion = TCPConfig::Congestion::NewReno;
+
+      // segment i covers [isn + 1 + i * mss, isn + 1 + (i + 1) * mss)
+      const auto seg = [&]( uint64_t i ) { return isn + 1 + uint32_t( i * mss ); };
+      const auto sacked = [&]( uint64_t first, uint64_t last ) {
+        return SackBlock { seg( first ), seg( last ) };
+      };
+
+      TCPSenderTestHarness test { "Fast recovery retransmits each hole the SACK blocks reveal", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 2 * initial_window, 'x' ) } );
+      for ( uint64_t i = 0; i < initial_window / mss; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( seg( i ) ) );
+      }
+
+      // segments 0, 2 and 4 are lost
+      test.execute( AckReceived { seg( 0 ) }.with_win( 60000 ).with_sack( { sacked( 1, 2 ) } ) );
+      test.execute( AckReceived { seg( 0 ) }.with_win( 60000 ).with_sack( { sacked( 1, 2 ), sacked( 3, 4 ) } ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute(
+        AckReceived { seg( 0 ) }.with_win( 60000 ).with_sack( { sacked( 1, 2 ), sacked( 3, 4 ), sacked( 5, 6 ) } ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( seg( 0 ) ) );
+      test.execute( ExpectNoSegment {} );
+
+      // each further duplicate repairs the next hole below the highest SACKed segment, without waiting for a
+      // partial ack
+      test.execute(
+        AckReceived { seg( 0 ) }.with_win( 60000 ).with_sack( { sacked( 1, 2 ), sacked( 3, 4 ), sacked( 5, 7 ) } ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( seg( 2 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute(
+        AckReceived { seg( 0 ) }.with_win( 60000 ).with_sack( { sacked( 1, 2 ), sacked( 3, 4 ), sacked( 5, 8 ) } ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( seg( 4 ) ) );
+      test.execute( ExpectNoSegment {} );
+
+      // no holes are left: the inflated window lets new data out instead
+      test.execute(
+        AckReceived { seg( 0 ) }.with_win( 60000 ).with_sack( { sacked( 1, 2 ), sacked( 3, 4 ), sacked( 5, 9 ) } ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( seg( 10 ) ) );
+      test.execute( ExpectNoSegment {} );
+
+      // the retransmissions arrive and recovery ends
+      test.execute( AckReceived { seg( 11 ) }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 2 * mss } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( seg( 11 ) ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( seg( 12 ) ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.sack = true;
+      cfg.rt_timeout = 100;
+
+      const auto seg = [&]( uint64_t i ) { return isn + 1 + uint32_t( i * mss ); };
+
+      TCPSenderTestHarness test { "After a timeout, SACKed holes are repaired one per ack", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 4 * mss, 'x' ) } );
+      for ( uint64_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( seg( i ) ) );
+      }
+      test.execute( AckReceived { seg( 0 ) }.with_win( 60000 ).with_sack( { { seg( 1 ), seg( 2 ) } } ) );
+      test.execute(
+        AckReceived { seg( 0 ) }.with_win( 60000 ).with_sack( { { seg( 1 ), seg( 2 ) }, { seg( 3 ), seg( 4 ) } } ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 100 } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( seg( 0 ) ) );
+      test.execute( ExpectNoSegment {} );
+
+      // segment 2 is a known hole: it goes out with the ack for segment 0 rather than after another timeout
+      test.execute( AckReceived { seg( 2 ) }.with_win( 60000 ).with_sack( { { seg( 3 ), seg( 4 ) } } ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( seg( 2 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { seg( 4 ) }.with_win( 60000 ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
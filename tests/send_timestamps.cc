@@ -0,0 +1,139 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "No timestamps unless configured", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( {} ) );
+      test.execute( EnableTimestamps {} );
+      test.execute( AckReceived { isn + 1 } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( {} ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.timestamps = true;
+
+      TCPSenderTestHarness test { "SYN offers timestamps; data is stamped only if the peer agreed", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( 0 ) );
+      test.execute( Tick { 10 } );
+      test.execute( AckReceived { isn + 1 } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( {} ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.timestamps = true;
+
+      TCPSenderTestHarness test { "Every segment carries the clock, including retransmissions", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( 0 ) );
+      test.execute( EnableTimestamps {} );
+      test.execute( Tick { 5 } );
+      test.execute( AckReceived { isn + 1 }.with_timestamp_echo( 0 ) );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( 5 ) );
+      test.execute( Tick { 20 } );
+      test.execute( Push { "d" } );
+      test.execute( ExpectMessage {}.with_data( "d" ).with_timestamp( 25 ) );
+      test.execute( Tick { 980 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( 1005 ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.adaptive_rto = true;
+      cfg.min_rto_ms = 10;
+
+      TCPSenderTestHarness test { "Without timestamps, a retransmitted segment gives no RTT sample", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { isn + 1 } );
+      test.execute( ExpectRTO { 150 } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Tick { 150 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Tick { 40 } );
+      test.execute( AckReceived { isn + 4 } );
+      test.execute( ExpectRTO { 150 } ); // Karn's algorithm: no sample
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.adaptive_rto = true;
+      cfg.min_rto_ms = 10;
+      cfg.timestamps = true;
+
+      TCPSenderTestHarness test { "The echoed timestamp gives an RTT sample for a retransmitted segment", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( 0 ) );
+      test.execute( EnableTimestamps {} );
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { isn + 1 }.with_timestamp_echo( 0 ) );
+      test.execute( ExpectRTO { 150 } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( 50 ) );
+      test.execute( Tick { 150 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( 200 ) );
+      test.execute( Tick { 40 } );
+      test.execute( AckReceived { isn + 4 }.with_timestamp_echo( 200 ) );
+      // RTT = 40: RTTVAR = 3/4 * 25 + 1/4 * |50 - 40| = 21.25, SRTT = 7/8 * 50 + 1/8 * 40 = 48.75
+      test.execute( ExpectRTO { 134 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.mss = 500;
+      cfg.timestamps = true;
+
+      TCPSenderTestHarness test { "Full segments leave room in the MSS for the timestamp option", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( 0 ) );
+      test.execute( Push { string( 1000, 'x' ) } );
+      test.execute( EnableTimestamps {} );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      // 488 bytes of payload + 12 bytes of timestamp option = the 500-byte MSS (RFC 6691)
+      test.execute( ExpectMessage {}.with_payload_size( 488 ).with_seqno( isn + 1 ).with_timestamp( 0 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 488 ).with_seqno( isn + 489 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 24 ).with_seqno( isn + 977 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -11,6 +11,7 @@
 #include <queue>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 const unsigned int DEFAULT_TEST_WINDOW = 137;
 
@@ -55,7 +56,7 @@ public:
   TCPSenderTestHarness( std::string name, TCPConfig config )
     : TestHarness( move( name ),
                    "initial_RTO_ms=" + to_string( config.rt_timeout ) + " and ISN=" + to_string( config.isn ),
-                   { TCPSender { ByteStream { config.send_capacity }, config.isn, config.rt_timeout } } )
+                   { TCPSender { ByteStream { config.send_capacity }, config } } )
   {}
 
   template<std::derived_from<TestStep<TCPSender>> T>
@@ -104,6 +105,60 @@ struct ExpectConsecutiveRetransmissions : public ExpectNumber<TCPSender, uint64_
   uint64_t value( const TCPSender& sender ) const override { return sender.consecutive_retransmissions(); }
 };
 
+struct ExpectRTO : public ExpectNumber<TCPSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "rto_ms"; }
+  uint64_t value( const TCPSender& sender ) const override { return sender.rto_ms(); }
+};
+
+struct ExpectCongestionWindow : public ExpectNumber<TCPSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "congestion_control()->cwnd()"; }
+  uint64_t value( const TCPSender& sender ) const override
+  {
+    if ( not sender.congestion_control() ) {
+      throw ExpectationViolation( "TCPSender has no congestion control" );
+    }
+    return sender.congestion_control()->cwnd();
+  }
+};
+
+struct ExpectSlowStartThreshold : public ExpectNumber<TCPSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "congestion_control()->ssthresh()"; }
+  uint64_t value( const TCPSender& sender ) const override
+  {
+    if ( not sender.congestion_control() ) {
+      throw ExpectationViolation( "TCPSender has no congestion control" );
+    }
+    return sender.congestion_control()->ssthresh();
+  }
+};
+
+struct ExpectPacingRate : public ExpectNumber<TCPSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "pacing_rate"; }
+  uint64_t value( const TCPSender& sender ) const override { return sender.pacing_rate(); }
+};
+
+struct ExpectNextSendMs : public ExpectNumber<TCPSender, std::optional<uint64_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "next_send_ms"; }
+  std::optional<uint64_t> value( const TCPSender& sender ) const override { return sender.next_send_ms(); }
+};
+
+struct ExpectSendBufferSize : public ExpectNumber<TCPSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "send_buffer_size"; }
+  uint64_t value( const TCPSender& sender ) const override { return sender.send_buffer_size(); }
+};
+
 struct ExpectNoSegment : public Expectation<SenderAndOutput>
 {
   std::string description() const override { return "nothing to send"; }
@@ -217,12 +272,23 @@ struct Receive : public Action<SenderAndOutput>
 {
   TCPReceiverMessage msg_;
   bool push_ = true;
+  bool with_data_ {};
 
   explicit Receive( TCPReceiverMessage msg ) : msg_( msg ) {}
   std::string description() const override
   {
     std::ostringstream desc;
-    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size << ")";
+    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size;
+    if ( not msg_.sack.empty() ) {
+      desc << ", sack=" << to_string( msg_.sack );
+    }
+    if ( msg_.timestamp_echo.has_value() ) {
+      desc << ", tsecr=" << *msg_.timestamp_echo;
+    }
+    desc << ")";
+    if ( with_data_ ) {
+      desc << " on a data segment";
+    }
     if ( push_ ) {
       desc << ", then push";
     }
@@ -237,12 +303,30 @@ struct Receive : public Action<SenderAndOutput>
 
   void execute( SenderAndOutput& ss ) const override
   {
-    ss.sender.receive( msg_ );
+    ss.sender.receive( msg_, with_data_ );
     if ( push_ ) {
       ss.sender.push( ss.make_transmit() );
     }
   }
 
+  Receive& with_sack( std::vector<SackBlock> sack )
+  {
+    msg_.sack = std::move( sack );
+    return *this;
+  }
+
+  Receive& with_timestamp_echo( uint32_t echo )
+  {
+    msg_.timestamp_echo = echo;
+    return *this;
+  }
+
+  Receive& on_data_segment()
+  {
+    with_data_ = true;
+    return *this;
+  }
+
   Receive& without_push()
   {
     push_ = false;
@@ -257,6 +341,55 @@ struct AckReceived : public Receive
   explicit AckReceived( Wrap32 ackno ) : Receive( { ackno, DEFAULT_TEST_WINDOW } ) {}
 };
 
+struct SetWindowScale : public Action<SenderAndOutput>
+{
+  uint8_t shift_;
+
+  explicit SetWindowScale( uint8_t shift ) : shift_( shift ) {}
+  std::string description() const override { return "peer's window scale = " + std::to_string( shift_ ); }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.set_window_scale( shift_ ); }
+};
+
+struct SetPeerMss : public Action<SenderAndOutput>
+{
+  uint16_t mss_;
+
+  explicit SetPeerMss( uint16_t mss ) : mss_( mss ) {}
+  std::string description() const override { return "peer's MSS = " + std::to_string( mss_ ); }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.set_peer_mss( mss_ ); }
+};
+
+struct EnableTimestamps : public Action<SenderAndOutput>
+{
+  std::string description() const override { return "peer's SYN carried timestamps"; }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.enable_timestamps(); }
+};
+
+struct SetNodelay : public Action<SenderAndOutput>
+{
+  bool nodelay_;
+
+  explicit SetNodelay( bool nodelay ) : nodelay_( nodelay ) {}
+  std::string description() const override { return nodelay_ ? "set nodelay" : "clear nodelay"; }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.set_nodelay( nodelay_ ); }
+};
+
+struct Cork : public Action<SenderAndOutput>
+{
+  std::string description() const override { return "cork"; }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.cork(); }
+};
+
+struct Uncork : public Action<SenderAndOutput>
+{
+  std::string description() const override { return "uncork, then push"; }
+  void execute( SenderAndOutput& ss ) const override
+  {
+    ss.sender.uncork();
+    ss.sender.push( ss.make_transmit() );
+  }
+};
+
 struct Close : public Push
 {
   Close() : Push( "" ) { with_close(); }
@@ -283,8 +416,16 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
   std::optional<Wrap32> seqno {};
   std::optional<std::string> data {};
   std::optional<size_t> payload_size {};
+  std::optional<bool> sack_permitted {};
+  std::optional<std::optional<uint8_t>> window_scale {};
+  std::optional<std::optional<uint16_t>> mss {};
+  std::optional<std::optional<uint32_t>> timestamp {};
 
-  bool empty() const { return not( syn or fin or rst or seqno or data or payload_size ); }
+  bool empty() const
+  {
+    return not( syn or fin or rst or seqno or data or payload_size or sack_permitted or window_scale or mss
+                or timestamp );
+  }
 
   ExpectMessage& with_syn( bool syn_ )
   {
@@ -330,6 +471,30 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     return *this;
   }
 
+  ExpectMessage& with_sack_permitted( bool sack_permitted_ )
+  {
+    sack_permitted = sack_permitted_;
+    return *this;
+  }
+
+  ExpectMessage& with_window_scale( std::optional<uint8_t> window_scale_ )
+  {
+    window_scale = window_scale_;
+    return *this;
+  }
+
+  ExpectMessage& with_mss( std::optional<uint16_t> mss_ )
+  {
+    mss = mss_;
+    return *this;
+  }
+
+  ExpectMessage& with_timestamp( std::optional<uint32_t> timestamp_ )
+  {
+    timestamp = timestamp_;
+    return *this;
+  }
+
   std::string message_description() const
   {
     std::ostringstream o;
@@ -361,6 +526,18 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     if ( rst.has_value() ) {
       o << ( rst.value() ? " +RST" : " -RST" );
     }
+    if ( sack_permitted.has_value() ) {
+      o << ( sack_permitted.value() ? " +SACK_PERM" : " -SACK_PERM" );
+    }
+    if ( window_scale.has_value() ) {
+      o << " wscale=" << to_string( window_scale.value() );
+    }
+    if ( mss.has_value() ) {
+      o << " mss=" << to_string( mss.value() );
+    }
+    if ( timestamp.has_value() ) {
+      o << " tsval=" << to_string( timestamp.value() );
+    }
     return o.str();
   }
 
@@ -377,10 +554,10 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
 
     const TCPSenderMessage seg = ss.expect_message();
 
-    if ( seg.payload.size() > TCPConfig::MAX_PAYLOAD_SIZE ) {
+    if ( seg.payload.size() > ss.sender.max_payload() ) {
       throw ExpectationViolation( "sent a message with a " + std::to_string( seg.payload.size() )
                                   + "-byte payload, which is longer than the maximum ("
-                                  + std::to_string( TCPConfig::MAX_PAYLOAD_SIZE ) + ")" );
+                                  + std::to_string( ss.sender.max_payload() ) + ")" );
     }
     if ( syn.has_value() and seg.SYN != syn.value() ) {
       throw MessageExpectationViolation( seg, "SYN flag", syn.value(), seg.SYN );
@@ -391,6 +568,18 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     if ( rst.has_value() and seg.RST != rst.value() ) {
       throw MessageExpectationViolation( seg, "RST flag", rst.value(), seg.RST );
     }
+    if ( sack_permitted.has_value() and seg.sack_permitted != sack_permitted.value() ) {
+      throw MessageExpectationViolation( seg, "SACK-permitted option", sack_permitted.value(), seg.sack_permitted );
+    }
+    if ( window_scale.has_value() and seg.window_scale != window_scale.value() ) {
+      throw MessageExpectationViolation( seg, "window scale", window_scale.value(), seg.window_scale );
+    }
+    if ( mss.has_value() and seg.mss != mss.value() ) {
+      throw MessageExpectationViolation( seg, "MSS option", mss.value(), seg.mss );
+    }
+    if ( timestamp.has_value() and seg.timestamp != timestamp.value() ) {
+      throw MessageExpectationViolation( seg, "timestamp", timestamp.value(), seg.timestamp );
+    }
     if ( seqno.has_value() and seg.seqno != seqno.value() ) {
       throw MessageExpectationViolation( seg, "sequence number", seqno.value(), seg.seqno );
     }
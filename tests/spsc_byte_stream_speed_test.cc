@@ -0,0 +1,215 @@
+#include "helpers.hh"
+#include "socket.hh"
+#include "tcp_minnow_socket_impl.hh"
+#include "tcp_over_ip.hh"
+
+#include "exception.hh"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <sys/socket.h>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+// A link between two TCPMinnowSockets in one process: IPv4 datagrams over an AF_UNIX stream socket, each
+// prefixed with its length. (A datagram socketpair would drop most of a window: its queue holds ~10 datagrams.)
+class LoopbackAdapter : public TCPOverIPv4Adapter
+{
+  LocalStreamSocket link_;
+
+  // Read exactly `buffer.size()` bytes; false at EOF
+  bool read_exact( string& buffer )
+  {
+    size_t filled = 0;
+    while ( filled < buffer.size() ) {
+      string piece( buffer.size() - filled, '\0' );
+      link_.read( piece );
+      if ( piece.empty() ) {
+        return false;
+      }
+      buffer.replace( filled, piece.size(), piece );
+      filled += piece.size();
+    }
+    return true;
+  }
+
+public:
+  explicit LoopbackAdapter( LocalStreamSocket&& link ) : link_( std::move( link ) ) {}
+
+  optional<TCPMessage> read()
+  {
+    string header( 2, '\0' );
+    if ( not read_exact( header ) ) {
+      return {};
+    }
+    string datagram( static_cast<uint8_t>( header[0] ) << 8U | static_cast<uint8_t>( header[1] ), '\0' );
+    if ( not read_exact( datagram ) ) {
+      return {};
+    }
+
+    InternetDatagram ip_dgram;
+    if ( parse( ip_dgram, vector<string> { std::move( datagram ) } ) ) {
+      return unwrap_tcp_in_ip( std::move( ip_dgram ) );
+    }
+    return {};
+  }
+
+  void write( const TCPMessage& msg )
+  {
+    for ( const auto& piece : split_to_mtu( msg ) ) {
+      const string datagram = concat( serialize( wrap_tcp_in_ip( piece ) ) );
+      string frame { static_cast<char>( datagram.size() >> 8U ), static_cast<char>( datagram.size() & 0xffU ) };
+      frame += datagram;
+      for ( string_view rest = frame; not rest.empty(); ) {
+        rest.remove_prefix( link_.write( rest ) );
+      }
+    }
+  }
+
+  FileDescriptor& fd() { return link_; }
+};
+
+using LoopbackMinnowSocket = TCPMinnowSocket<LoopbackAdapter>;
+
+pair<LoopbackAdapter, LoopbackAdapter> make_link()
+{
+  array<int, 2> fds {};
+  CheckSystemCall( "socketpair", ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds.data() ) );
+  return { LoopbackAdapter { LocalStreamSocket { FileDescriptor { fds[0] } } },
+           LoopbackAdapter { LocalStreamSocket { FileDescriptor { fds[1] } } } };
+}
+
+// Send `data` from this thread through one TCPMinnowSocket to a second one, whose owner is another thread, in
+// chunks of `write_size`. The owners use the sockets' fds (DataPath::SocketPair) or read_direct() and
+// write_direct() (DataPath::SPSC). Returns what the receiving owner read, and the time it took.
+pair<string, duration<double>> through_minnow_socket( const string& data,
+                                                      size_t write_size,
+                                                      LoopbackMinnowSocket::DataPath data_path )
+{
+  const bool direct = data_path == LoopbackMinnowSocket::DataPath::SPSC;
+  auto [client_link, server_link] = make_link();
+  LoopbackMinnowSocket client { std::move( client_link ), data_path };
+  LoopbackMinnowSocket server { std::move( server_link ), data_path };
+
+  TCPConfig tcp_config;
+  tcp_config.rt_timeout = 50; // the client lingers for ten of these after closing
+  FdAdapterConfig server_config;
+  server_config.source = Address { "10.144.0.2", 4000 };
+  server_config.mtu = 1500;
+  FdAdapterConfig client_config;
+  client_config.source = Address { "10.144.0.1", 3000 };
+  client_config.destination = server_config.source;
+  client_config.mtu = 1500;
+
+  string output;
+  output.reserve( data.size() );
+  thread server_owner( [&] {
+    server.listen_and_accept( tcp_config, server_config );
+    string buffer;
+    if ( direct ) {
+      while ( not server.eof_direct() ) {
+        server.read_direct( buffer );
+        output += buffer;
+      }
+    } else {
+      server.set_blocking( true );
+      while ( not server.eof() ) {
+        buffer.clear();
+        server.read( buffer );
+        output += buffer;
+      }
+    }
+  } );
+
+  client.connect( tcp_config, client_config );
+  const auto start_time = steady_clock::now();
+  if ( direct ) {
+    for ( size_t pos = 0; pos < data.size(); ) {
+      pos += client.write_direct( string_view( data ).substr( pos, write_size ) );
+    }
+    client.shutdown_write_direct();
+  } else {
+    client.set_blocking( true );
+    for ( size_t pos = 0; pos < data.size(); ) {
+      pos += client.write( string_view( data ).substr( pos, write_size ) );
+    }
+    client.shutdown( SHUT_WR );
+  }
+  server_owner.join();
+  const auto stop_time = steady_clock::now();
+
+  server.wait_until_closed();
+  client.wait_until_closed();
+  return { std::move( output ), stop_time - start_time };
+}
+
+void speed_test( fstream& debug_output,
+                 const string& data,
+                 const size_t write_size,
+                 string_view name,
+                 LoopbackMinnowSocket::DataPath data_path )
+{
+  const auto [output, test_duration] = through_minnow_socket( data, write_size, data_path );
+
+  if ( data != output ) {
+    throw runtime_error( "Mismatch between data written and read" );
+  }
+
+  auto gigabits_per_second = 8 * static_cast<double>( data.size() ) / test_duration.count() / 1e9;
+
+  cout << "TCPMinnowSocket over " << name << " with write_size=" << write_size << " reached " << fixed
+       << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
+
+  debug_output << "        TCPMinnowSocket throughput (" << name << "):" << string( 12 - name.size(), ' ' )
+               << fixed << setprecision( 2 ) << setw( 5 ) << gigabits_per_second << " Gbit/s\n";
+
+  if ( gigabits_per_second < 0.01 ) {
+    throw runtime_error( "TCPMinnowSocket did not meet minimum speed of 0.01 Gbit/s" );
+  }
+}
+
+void program_body()
+{
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  const string data = [] {
+    default_random_engine rd { 1234 };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < 2e7; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  speed_test( debug_output, data, 16384, "socketpair", LoopbackMinnowSocket::DataPath::SocketPair );
+  speed_test( debug_output, data, 16384, "spsc", LoopbackMinnowSocket::DataPath::SPSC );
+  speed_test( debug_output, data, 1500, "socketpair", LoopbackMinnowSocket::DataPath::SocketPair );
+  speed_test( debug_output, data, 1500, "spsc", LoopbackMinnowSocket::DataPath::SPSC );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,76 @@
+#include "spsc_byte_stream.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+using namespace std;
+
+namespace {
+
+// Move `data` through a tiny SPSCByteStream, so that both the writer and the reader keep running into a full or
+// empty buffer and going to sleep. A lost wakeup leaves both threads blocked, and the test times out.
+void stress( const string& data, uint64_t capacity, size_t write_size, size_t read_size )
+{
+  SPSCByteStream pipe { capacity };
+  string output;
+  output.reserve( data.size() );
+
+  thread writer( [&] {
+    size_t pos = 0;
+    while ( pos < data.size() ) {
+      const auto len = pipe.push( string_view( data ).substr( pos, write_size ) );
+      if ( len == 0 ) {
+        pipe.wait_writable();
+      }
+      pos += len;
+    }
+    pipe.close();
+  } );
+
+  while ( not pipe.is_finished() ) {
+    const auto view = pipe.peek().substr( 0, read_size );
+    if ( view.empty() ) {
+      pipe.wait_readable();
+      continue;
+    }
+    output += view;
+    pipe.pop( view.size() );
+  }
+  writer.join();
+
+  if ( output != data ) {
+    throw runtime_error( "SPSCByteStream with capacity " + to_string( capacity ) + " corrupted the data" );
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    default_random_engine rd { 4471 };
+    uniform_int_distribution<char> ud;
+    string data;
+    for ( size_t i = 0; i < 100000; i++ ) {
+      data += ud( rd );
+    }
+
+    stress( data, 1, 1, 1 );
+    stress( data, 2, 3, 1 );
+    stress( data, 3, 1, 2 );
+    stress( data, 7, 5, 7 );
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,288 @@
+#include "tcp_link_simulator.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+void program_body()
+{
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  const string data = [] {
+    default_random_engine rd { 1144 };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < 2'000'000; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  const vector<pair<string_view, TCPConfig::Congestion>> algorithms {
+    { "none", TCPConfig::Congestion::None },
+    { "reno", TCPConfig::Congestion::Reno },
+    { "newreno", TCPConfig::Congestion::NewReno },
+    { "cubic", TCPConfig::Congestion::Cubic },
+    { "bbr", TCPConfig::Congestion::BBR },
+  };
+
+  for ( const double loss : { 0.0, 0.001, 0.01 } ) {
+    for ( const bool sack : { false, true } ) {
+      for ( const auto& [algorithm_name, algorithm] : algorithms ) {
+        const string name = string( algorithm_name ) + ( sack ? "+sack" : "" );
+        TCPConfig config;
+        config.adaptive_rto = true;
+        config.congestion = algorithm;
+        config.sack = sack;
+        TCPConfig server_config = config;
+        server_config.isn = Wrap32 { 90210 };
+
+        const LinkConfig link { .loss = loss };
+        const auto result = run_transfer( config, server_config, link, data, 1 );
+
+        cout << "TCP (" << name << ") over a 20 Mbit/s, 20 ms RTT link with " << loss * 100 << "% loss reached "
+             << fixed << setprecision( 2 ) << result.goodput_mbps( data.size() ) << " Mbit/s ("
+             << result.segments_sent << " segments sent, " << result.queue_drops << " queue drops, "
+             << result.random_drops << " random drops).\n";
+        cout.unsetf( ios::fixed );
+
+        debug_output << "        " << left << setw( 13 ) << name << right << setw( 6 ) << loss * 100 << "% loss "
+                     << fixed << setprecision( 2 ) << setw( 8 ) << result.goodput_mbps( data.size() ) << " Mbit/s\n";
+        debug_output.unsetf( ios::fixed );
+      }
+    }
+  }
+
+  // A long fat pipe: the bandwidth-delay product (1.25 MB) is far beyond a 64 KiB window
+  for ( const bool window_scaling : { false, true } ) {
+    for ( const auto& [algorithm_name, algorithm] : algorithms ) {
+      const string name = string( algorithm_name ) + ( window_scaling ? "+wscale" : "" );
+      TCPConfig config;
+      config.adaptive_rto = true;
+      config.congestion = algorithm;
+      config.recv_capacity = 4'000'000;
+      config.send_capacity = 4'000'000;
+      config.window_scaling = window_scaling;
+      TCPConfig server_config = config;
+      server_config.isn = Wrap32 { 90210 };
+
+      const LinkConfig link { .rate_bytes_per_ms = 12500, .delay_ms = 50, .queue_bytes = 1'000'000 };
+      const auto result = run_transfer( config, server_config, link, data, 1 );
+
+      cout << "TCP (" << name << ") over a 100 Mbit/s, 100 ms RTT link reached " << fixed << setprecision( 2 )
+           << result.goodput_mbps( data.size() ) << " Mbit/s (" << result.segments_sent << " segments sent).\n";
+      cout.unsetf( ios::fixed );
+
+      debug_output << "        " << left << setw( 15 ) << name << " long fat pipe " << fixed << setprecision( 2 )
+                   << setw( 8 ) << result.goodput_mbps( data.size() ) << " Mbit/s\n";
+      debug_output.unsetf( ios::fixed );
+    }
+  }
+
+  // Receive-buffer autotuning on the long fat pipe: a fixed 64 kB buffer caps the window well below the
+  // bandwidth-delay product, a fixed 4 MB one is mostly idle memory, and autotuning starts at 64 kB and grows
+  struct ReceiveBuffer
+  {
+    string_view name;
+    size_t capacity;
+    bool autotune;
+  };
+  const vector<ReceiveBuffer> receive_buffers {
+    { "rcvbuf=64k", 64'000, false },
+    { "rcvbuf=4M", 4'000'000, false },
+    { "autotune", 64'000, true },
+  };
+  for ( const auto& [buffer_name, capacity, autotune] : receive_buffers ) {
+    TCPConfig config;
+    config.adaptive_rto = true;
+    config.congestion = TCPConfig::Congestion::Cubic;
+    config.sack = true;
+    config.send_capacity = 4'000'000;
+    config.window_scaling = true;
+    TCPConfig server_config = config;
+    server_config.isn = Wrap32 { 90210 };
+    server_config.recv_capacity = capacity;
+    server_config.recv_autotune = autotune;
+
+    const LinkConfig link { .rate_bytes_per_ms = 12500, .delay_ms = 50, .queue_bytes = 1'000'000 };
+    const auto result = run_transfer( config, server_config, link, data, 1 );
+
+    cout << "TCP (cubic+wscale, " << buffer_name << ") over a 100 Mbit/s, 100 ms RTT link reached " << fixed
+         << setprecision( 2 ) << result.goodput_mbps( data.size() ) << " Mbit/s (receive buffer ended at "
+         << result.receive_capacity << " bytes).\n";
+    cout.unsetf( ios::fixed );
+
+    debug_output << "        " << left << setw( 15 ) << buffer_name << " long fat pipe " << fixed
+                 << setprecision( 2 ) << setw( 8 ) << result.goodput_mbps( data.size() ) << " Mbit/s\n";
+    debug_output.unsetf( ios::fixed );
+  }
+
+  // Send-buffer autosizing on a 1 Gbit/s link: the client refills its outbound stream once per millisecond,
+  // so a fixed 64 kB send buffer can't keep more than 64 kB/ms (512 Mbit/s) moving. BBR, so that slow-start
+  // overshoot into the queue doesn't hide the difference.
+  string bulk;
+  for ( size_t i = 0; i < 10; i++ ) {
+    bulk += data;
+  }
+  for ( const bool send_autotune : { false, true } ) {
+    TCPConfig config;
+    config.adaptive_rto = true;
+    config.congestion = TCPConfig::Congestion::BBR;
+    config.sack = true;
+    config.window_scaling = true;
+    config.recv_capacity = 16'000'000;
+    config.send_autotune = send_autotune;
+    TCPConfig server_config = config;
+    server_config.isn = Wrap32 { 90210 };
+
+    const LinkConfig link { .rate_bytes_per_ms = 125'000, .delay_ms = 5, .queue_bytes = 4'000'000 };
+    const auto result = run_transfer( config, server_config, link, bulk, 1 );
+    const string_view name = send_autotune ? "sndbuf=auto" : "sndbuf=64k";
+
+    cout << "TCP (bbr+wscale, " << name << ") over a 1 Gbit/s, 10 ms RTT link reached " << fixed
+         << setprecision( 2 ) << result.goodput_mbps( bulk.size() ) << " Mbit/s.\n";
+    cout.unsetf( ios::fixed );
+
+    debug_output << "        " << left << setw( 15 ) << name << " 1 Gbit/s " << fixed << setprecision( 2 )
+                 << setw( 8 ) << result.goodput_mbps( bulk.size() ) << " Mbit/s\n";
+    debug_output.unsetf( ios::fixed );
+  }
+
+  // Pacing against a shallow bottleneck buffer: window-sized bursts overflow it, paced segments don't
+  for ( const bool pacing : { false, true } ) {
+    for ( const auto& [algorithm_name, algorithm] : algorithms ) {
+      const string name = string( algorithm_name ) + ( pacing ? "+pacing" : "" );
+      TCPConfig config;
+      config.adaptive_rto = true;
+      config.congestion = algorithm;
+      config.sack = true;
+      config.pacing = pacing;
+      TCPConfig server_config = config;
+      server_config.isn = Wrap32 { 90210 };
+
+      const LinkConfig link { .queue_bytes = 8000 };
+      const auto result = run_transfer( config, server_config, link, data, 1 );
+
+      cout << "TCP (" << name << ") over a 20 Mbit/s, 20 ms RTT link with an 8 kB queue reached " << fixed
+           << setprecision( 2 ) << result.goodput_mbps( data.size() ) << " Mbit/s (" << result.segments_sent
+           << " segments sent, " << result.queue_drops << " queue drops).\n";
+      cout.unsetf( ios::fixed );
+
+      debug_output << "        " << left << setw( 15 ) << name << " 8 kB queue " << fixed << setprecision( 2 )
+                   << setw( 8 ) << result.goodput_mbps( data.size() ) << " Mbit/s\n";
+      debug_output.unsetf( ios::fixed );
+    }
+  }
+
+  // Interactive traffic: a writer trickling 10 bytes per millisecond. Without Nagle every write is its own
+  // segment; with it, small writes wait for the previous segment's ack and go out together.
+  const string keystrokes = data.substr( 0, 4000 );
+  for ( const bool nagle : { false, true } ) {
+    TCPConfig config;
+    config.adaptive_rto = true;
+    config.congestion = TCPConfig::Congestion::Cubic;
+    config.nagle = nagle;
+    TCPConfig server_config = config;
+    server_config.isn = Wrap32 { 90210 };
+
+    const auto result = run_transfer( config, server_config, LinkConfig {}, keystrokes, 1, 600'000, 10 );
+    const string_view name = nagle ? "cubic+nagle" : "cubic";
+
+    cout << "TCP (" << name << ") sending 10 bytes/ms over a 20 Mbit/s, 20 ms RTT link finished in "
+         << result.duration_ms << " ms (" << result.segments_sent << " segments sent).\n";
+
+    debug_output << "        " << left << setw( 15 ) << name << " 10 B/ms writer " << right << setw( 6 )
+                 << result.segments_sent << " segments\n";
+  }
+
+  // Delayed acks: one ack per two segments halves the receiver's packet rate on a bulk transfer
+  for ( const bool delayed_ack : { false, true } ) {
+    TCPConfig config;
+    config.adaptive_rto = true;
+    config.congestion = TCPConfig::Congestion::Cubic;
+    config.sack = true;
+    TCPConfig server_config = config;
+    server_config.isn = Wrap32 { 90210 };
+    server_config.delayed_ack = delayed_ack;
+
+    const auto result = run_transfer( config, server_config, LinkConfig {}, data, 1 );
+    const string_view name = delayed_ack ? "cubic+delack" : "cubic";
+
+    cout << "TCP (" << name << ") over a 20 Mbit/s, 20 ms RTT link reached " << fixed << setprecision( 2 )
+         << result.goodput_mbps( data.size() ) << " Mbit/s (" << result.segments_sent << " segments, "
+         << result.acks_sent << " acks).\n";
+    cout.unsetf( ios::fixed );
+
+    debug_output << "        " << left << setw( 15 ) << name << " acks " << right << setw( 10 ) << result.acks_sent
+                 << "\n";
+  }
+
+  // Segment sizing: the default 1000-byte payloads, an MSS that fills a 1500-byte MTU, and super-segments of
+  // four MSS that the link splits to the MTU (fewer messages through the sender for the same bytes)
+  struct Sizing
+  {
+    string_view name;
+    optional<uint16_t> mss;
+    uint16_t gso_segments;
+  };
+  const vector<Sizing> sizings {
+    { "payload=1000", {}, 1 },
+    { "mss=1460", 1460, 1 },
+    { "mss=1460+gso4", 1460, 4 },
+  };
+
+  for ( const double loss : { 0.0, 0.01 } ) {
+    for ( const auto& [sizing_name, mss, gso_segments] : sizings ) {
+      TCPConfig config;
+      config.adaptive_rto = true;
+      config.congestion = TCPConfig::Congestion::Cubic;
+      config.sack = true;
+      config.mss = mss;
+      config.gso_segments = gso_segments;
+      TCPConfig server_config = config;
+      server_config.isn = Wrap32 { 90210 };
+
+      const LinkConfig link { .loss = loss, .mtu = 1500 };
+      const auto start = chrono::steady_clock::now();
+      const auto result = run_transfer( config, server_config, link, data, 1 );
+      const auto elapsed = chrono::duration_cast<chrono::microseconds>( chrono::steady_clock::now() - start );
+
+      cout << "TCP (cubic+sack, " << sizing_name << ") over a 20 Mbit/s, 20 ms RTT link with " << loss * 100
+           << "% loss reached " << fixed << setprecision( 2 ) << result.goodput_mbps( data.size() ) << " Mbit/s ("
+           << result.segments_sent << " segments sent, simulated in " << elapsed.count() / 1000 << " ms).\n";
+      cout.unsetf( ios::fixed );
+
+      debug_output << "        " << left << setw( 15 ) << sizing_name << right << setw( 4 ) << loss * 100
+                   << "% loss " << fixed << setprecision( 2 ) << setw( 8 ) << result.goodput_mbps( data.size() )
+                   << " Mbit/s\n";
+      debug_output.unsetf( ios::fixed );
+    }
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "common.hh"
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <deque>
+#include <string>
+#include <utility>
+
+// One direction of a connection: the messages a peer has sent, copied out of the transmit callback
+struct Wire
+{
+  std::deque<TCPMessage> messages {};
+
+  auto transmit()
+  {
+    return [this]( const TCPMessage& msg ) {
+      messages.push_back( { TCPSenderMessage { msg.sender.get() }, TCPReceiverMessage { msg.receiver.get() } } );
+    };
+  }
+
+  TCPMessage take()
+  {
+    expect( not messages.empty(), "expected a message, but none was sent" );
+    TCPMessage msg = std::move( messages.front() );
+    messages.pop_front();
+    return msg;
+  }
+};
+
+// Two TCPPeers that have completed the handshake, with nothing left on either wire
+struct Connection
+{
+  TCPPeer client;
+  TCPPeer server;
+  Wire to_server {};
+  Wire to_client {};
+
+  Connection( const TCPConfig& client_config, const TCPConfig& server_config )
+    : client( client_config ), server( server_config )
+  {
+    client.push( to_server.transmit() );
+    server.receive( to_server.take(), to_client.transmit() );
+    client.receive( to_client.take(), to_server.transmit() );
+    server.receive( to_server.take(), to_client.transmit() ); // ack of the server's SYN
+    expect( to_client.messages.empty() and to_server.messages.empty(), "handshake sent extra messages" );
+  }
+
+  // The client writes `data` and sends it, one message per MSS
+  void client_sends( const std::string& data )
+  {
+    client.outbound_writer().push( data );
+    client.push( to_server.transmit() );
+  }
+};
@@ -0,0 +1,134 @@
+#include "tcp_config.hh"
+#include "tcp_connection_fixture.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+TCPConfig config( bool delayed_ack )
+{
+  TCPConfig cfg;
+  cfg.delayed_ack = delayed_ack;
+  return cfg;
+}
+
+TCPConfig server_config( bool delayed_ack )
+{
+  TCPConfig cfg = config( delayed_ack );
+  cfg.isn = Wrap32 { 90210 };
+  return cfg;
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+    // Without delayed acks, every segment gets its own ack.
+    {
+      Connection c { config( false ), server_config( false ) };
+      c.client_sends( string( 2 * mss, 'x' ) );
+      c.server.receive( c.to_server.take(), c.to_client.transmit() );
+      c.server.receive( c.to_server.take(), c.to_client.transmit() );
+      expect( c.to_client.messages.size() == 2, "expected an ack for each segment" );
+    }
+
+    // With delayed acks, one segment waits for the timer.
+    {
+      Connection c { config( false ), server_config( true ) };
+      c.client_sends( "hello" );
+      c.server.receive( c.to_server.take(), c.to_client.transmit() );
+      expect( c.to_client.messages.empty(), "ack for a single segment was not delayed" );
+      expect( c.server.next_ack_ms() == TCPConfig::ACK_DELAY_DFLT, "delayed ack not due after ack_delay ms" );
+      c.server.tick( TCPConfig::ACK_DELAY_DFLT - 1, c.to_client.transmit() );
+      expect( c.to_client.messages.empty(), "delayed ack sent early" );
+      c.server.tick( 1, c.to_client.transmit() );
+      const TCPMessage ack = c.to_client.take();
+      expect( ack.sender->sequence_length() == 0, "delayed ack occupies sequence space" );
+      expect( ack.receiver->ackno == Wrap32 { 137 } + 6, "delayed ack has the wrong ackno" );
+      expect( not c.server.next_ack_ms().has_value(), "delayed ack still pending after it was sent" );
+    }
+
+    // The second segment is acked at once, together with the first.
+    {
+      Connection c { config( false ), server_config( true ) };
+      c.client_sends( string( 4 * mss, 'x' ) );
+      for ( size_t i = 0; i < 4; i++ ) {
+        c.server.receive( c.to_server.take(), c.to_client.transmit() );
+        expect( c.to_client.messages.size() == ( i + 1 ) / 2, "expected an ack for every second segment" );
+      }
+      expect( c.to_client.messages.back().receiver->ackno == Wrap32 { 137 } + 1 + 4 * mss, "wrong ackno" );
+      c.server.tick( TCPConfig::ACK_DELAY_DFLT, c.to_client.transmit() );
+      expect( c.to_client.messages.size() == 2, "extra ack after the segments were acked" );
+    }
+
+    // Out-of-order segments are acked at once, with the old ackno, so fast retransmit still works.
+    {
+      Connection c { config( false ), server_config( true ) };
+      c.client_sends( string( 3 * mss, 'x' ) );
+      c.to_server.take(); // lost
+      c.server.receive( c.to_server.take(), c.to_client.transmit() );
+      c.server.receive( c.to_server.take(), c.to_client.transmit() );
+      expect( c.to_client.messages.size() == 2, "out-of-order segments were not acked at once" );
+      expect( c.to_client.messages.back().receiver->ackno == Wrap32 { 137 } + 1, "expected a duplicate ack" );
+    }
+
+    // Outgoing data carries the ack, so no separate ack follows.
+    {
+      Connection c { config( false ), server_config( true ) };
+      c.client_sends( "request" );
+      c.server.receive( c.to_server.take(), c.to_client.transmit() );
+      expect( c.to_client.messages.empty(), "ack for a single segment was not delayed" );
+      c.server.outbound_writer().push( "response" );
+      c.server.push( c.to_client.transmit() );
+      const TCPMessage reply = c.to_client.take();
+      expect( reply.sender->payload == "response", "expected the response" );
+      expect( reply.receiver->ackno == Wrap32 { 137 } + 8, "response does not carry the ack" );
+      c.server.tick( TCPConfig::ACK_DELAY_DFLT, c.to_client.transmit() );
+      expect( c.to_client.messages.empty(), "separate ack sent after it was piggybacked" );
+    }
+
+    // Data flowing both ways repeats the same ackno and window, but acks riding on data are not duplicate acks:
+    // the peer's segments must not trigger a fast retransmit.
+    {
+      Connection c { config( false ), server_config( false ) };
+      c.client_sends( string( 4 * mss, 'c' ) );
+      c.server.outbound_writer().push( string( 4 * mss, 's' ) );
+      c.server.push( c.to_client.transmit() );
+      expect( c.to_server.messages.size() == 4 and c.to_client.messages.size() == 4,
+              "expected four segments each way" );
+      for ( size_t i = 0; i < 4; i++ ) {
+        c.client.receive( c.to_client.take(), c.to_server.transmit() );
+      }
+      expect( c.to_server.messages.size() == 8, "expected an ack for each of the server's segments" );
+      for ( size_t i = 4; i < 8; i++ ) {
+        expect( c.to_server.messages[i].sender->payload.empty(),
+                "data segments from the peer triggered a fast retransmit" );
+      }
+    }
+
+    // A FIN is acked at once.
+    {
+      Connection c { config( false ), server_config( true ) };
+      c.client.outbound_writer().close();
+      c.client.push( c.to_server.transmit() );
+      c.server.receive( c.to_server.take(), c.to_client.transmit() );
+      expect( c.to_client.messages.size() == 1, "FIN was not acked at once" );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
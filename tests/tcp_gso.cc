@@ -0,0 +1,127 @@
+#include "byte_stream.hh"
+#include "common.hh"
+#include "ipv4_header.hh"
+#include "tcp_config.hh"
+#include "tcp_over_ip.hh"
+#include "tcp_segment.hh"
+#include "tcp_sender.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+uint64_t datagram_length( const TCPMessage& msg )
+{
+  const TCPSegment seg { .message = { msg.sender.borrow(), msg.receiver.borrow() } };
+  return IPv4Header::LENGTH + seg.header_length() + msg.sender->payload.size();
+}
+
+// The pieces must fit the MTU, cover the original seqnos contiguously, and carry the original payload
+void check_pieces( const TCPMessage& whole, const vector<TCPMessage>& pieces, uint16_t mtu )
+{
+  string payload;
+  Wrap32 next = whole.sender->seqno;
+  for ( size_t i = 0; i < pieces.size(); i++ ) {
+    const TCPSenderMessage& piece = pieces[i].sender.get();
+    expect( datagram_length( pieces[i] ) <= mtu, "piece " + to_string( i ) + " exceeds the MTU" );
+    expect( piece.seqno == next, "piece " + to_string( i ) + " has the wrong seqno" );
+    expect( piece.SYN == ( i == 0 and whole.sender->SYN ), "SYN is not on the first piece only" );
+    expect( piece.FIN == ( i + 1 == pieces.size() and whole.sender->FIN ), "FIN is not on the last piece only" );
+    expect( pieces[i].receiver->ackno == whole.receiver->ackno, "piece lost the ackno" );
+    payload += piece.payload;
+    next = next + static_cast<uint32_t>( piece.sequence_length() );
+  }
+  expect( payload == whole.sender->payload, "payload changed in the split" );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    const Wrap32 ackno { 4000000000 };
+    const TCPMessage super { TCPSenderMessage { .seqno = Wrap32 { UINT32_MAX - 1000 },
+                                                .payload = string( 5000, 'x' ),
+                                                .FIN = true },
+                             TCPReceiverMessage { ackno, 1000 } };
+
+    {
+      TCPOverIPv4Adapter adapter;
+      expect( adapter.split_to_mtu( super ).size() == 1, "message split without an MTU" );
+    }
+
+    {
+      TCPOverIPv4Adapter adapter;
+      adapter.config_mut().mtu = 1500;
+      const auto pieces = adapter.split_to_mtu( super );
+      expect( pieces.size() == 4, "expected 4 pieces of at most 1460 bytes, got " + to_string( pieces.size() ) );
+      check_pieces( super, pieces, 1500 );
+    }
+
+    {
+      TCPMessage syn { TCPSenderMessage { .seqno = Wrap32 { 77 },
+                                          .SYN = true,
+                                          .payload = string( 3000, 'y' ),
+                                          .sack_permitted = true,
+                                          .window_scale = 7,
+                                          .mss = 1460 },
+                       TCPReceiverMessage { ackno, 1000 } };
+      syn.receiver->sack = { { ackno + 100, ackno + 200 }, { ackno + 300, ackno + 400 } };
+      TCPOverIPv4Adapter adapter;
+      adapter.config_mut().mtu = 1500;
+      const auto pieces = adapter.split_to_mtu( syn );
+      check_pieces( syn, pieces, 1500 );
+      expect( pieces.front().sender->mss == 1460, "SYN options not on the first piece" );
+      expect( pieces.size() == 3, "expected 3 pieces, got " + to_string( pieces.size() ) );
+    }
+
+    {
+      const TCPMessage small { TCPSenderMessage { .payload = string( 1460, 'z' ) }, TCPReceiverMessage {} };
+      TCPOverIPv4Adapter adapter;
+      adapter.config_mut().mtu = 1500;
+      expect( adapter.split_to_mtu( small ).size() == 1, "a segment that fits the MTU was split" );
+    }
+
+    {
+      // The peer's MSS (536) is below the link's (1460): super-segments are cut at the negotiated MSS
+      TCPConfig cfg;
+      cfg.mss = 1460;
+      cfg.gso_segments = 4;
+      TCPSender sender { ByteStream { cfg.send_capacity }, cfg };
+      vector<TCPSenderMessage> sent;
+      const auto transmit = [&]( const TCPSenderMessage& msg ) { sent.push_back( msg ); };
+      sender.push( transmit );
+      sender.receive( TCPReceiverMessage { cfg.isn + 1, 60000 } );
+      sender.set_peer_mss( 536 );
+      sender.writer().push( string( 4 * 536 + 712, 'w' ) );
+      sender.push( transmit );
+      expect( sent.size() == 3, "expected SYN and two super-segments, got " + to_string( sent.size() ) );
+
+      TCPOverIPv4Adapter adapter;
+      adapter.config_mut().mtu = 1500;
+      size_t piece_count = 0;
+      for ( size_t i = 1; i < sent.size(); i++ ) {
+        const TCPMessage msg { Ref<TCPSenderMessage>::borrow( sent[i] ), TCPReceiverMessage { ackno, 1000 } };
+        const auto pieces = adapter.split_to_mtu( msg );
+        check_pieces( msg, pieces, 1500 );
+        for ( const auto& piece : pieces ) {
+          expect( piece.sender->payload.size() <= 536, "a piece exceeds the peer's MSS" );
+        }
+        piece_count += pieces.size();
+      }
+      expect( piece_count == 6, "expected 6 pieces of at most 536 bytes, got " + to_string( piece_count ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,80 @@
+#include "tcp_config.hh"
+#include "tcp_connection_fixture.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+TCPConfig server_config()
+{
+  TCPConfig cfg;
+  cfg.isn = Wrap32 { 90210 };
+  return cfg;
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    const uint64_t linger_time = 10UL * TCPConfig::TIMEOUT_DFLT;
+
+    // The side that closes first lingers; the side that closes second does not.
+    {
+      Connection c { TCPConfig {}, server_config() };
+      c.client.outbound_writer().push( "hello" );
+      c.client.outbound_writer().close();
+      c.client.push( c.to_server.transmit() );
+      c.server.receive( c.to_server.take(), c.to_client.transmit() );
+      c.client.receive( c.to_client.take(), c.to_server.transmit() );
+      c.server.outbound_writer().close();
+      c.server.push( c.to_client.transmit() );
+      c.client.receive( c.to_client.take(), c.to_server.transmit() );
+      c.server.receive( c.to_server.take(), c.to_client.transmit() );
+      expect( not c.server.active(), "the side that closed second lingered" );
+      expect( c.client.active(), "the side that closed first did not linger" );
+      c.client.tick( linger_time, c.to_server.transmit() );
+      expect( not c.client.active(), "still active after lingering" );
+    }
+
+    // Our data and FIN are out but not yet acked when the peer's FIN arrives: we closed first, so we still
+    // linger once the peer acks everything.
+    {
+      Connection c { TCPConfig {}, server_config() };
+      c.client.outbound_writer().push( "hello" );
+      c.client.outbound_writer().close();
+      c.client.push( c.to_server.transmit() );
+      c.to_server.take(); // lost
+
+      c.server.outbound_writer().close();
+      c.server.push( c.to_client.transmit() );
+      c.client.receive( c.to_client.take(), c.to_server.transmit() );
+      expect( c.client.sender().fin_sent(), "client did not send its FIN" );
+      expect( not c.client.sender().reader().is_finished(), "client's data was acked" );
+      c.server.receive( c.to_server.take(), c.to_client.transmit() ); // ack of the server's FIN
+
+      c.client.tick( TCPConfig::TIMEOUT_DFLT, c.to_server.transmit() ); // retransmit data and FIN
+      c.server.receive( c.to_server.take(), c.to_client.transmit() );
+      c.client.receive( c.to_client.take(), c.to_server.transmit() );
+      expect( c.client.sender().reader().is_finished(), "client's data was not acked" );
+      expect( c.client.active(), "the side that closed first did not linger" );
+      c.client.tick( linger_time - 1, c.to_server.transmit() );
+      expect( c.client.active(), "stopped lingering early" );
+      c.client.tick( 1, c.to_server.transmit() );
+      expect( not c.client.active(), "still active after lingering" );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
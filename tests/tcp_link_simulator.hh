@@ -0,0 +1,195 @@
+#pragma once
+
+#include "helpers.hh"
+#include "ipv4_header.hh"
+#include "tcp_config.hh"
+#include "tcp_over_ip.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <optional>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// One direction of a simulated path: a drop-tail bottleneck of fixed rate, a fixed propagation delay,
+// and random per-segment loss in the style of LossyFdAdapter.
+struct LinkConfig
+{
+  uint64_t rate_bytes_per_ms = 2500; // bottleneck rate (2500 bytes/ms = 20 Mbit/s)
+  uint64_t delay_ms = 10;            // one-way propagation delay
+  uint64_t queue_bytes = 32000;      // bottleneck buffer; arrivals that don't fit are dropped
+  double loss = 0;                   // probability that a segment is lost on the wire
+  bool serialize = true;             // round-trip every segment through TCPSegment::serialize/parse
+  std::optional<uint16_t> mtu {};    // if set, super-segments are split to fit, as TCPOverIPv4Adapter does
+};
+
+class SimulatedLink
+{
+public:
+  SimulatedLink( const LinkConfig& config, uint64_t seed ) : config_( config ), rd_( seed )
+  {
+    adapter_.config_mut().mtu = config.mtu;
+  }
+
+  // Wire size of a segment (payload plus IPv4 and TCP headers, with options)
+  static uint64_t wire_size( const TCPMessage& msg )
+  {
+    const TCPSegment seg { .message = { msg.sender.borrow(), msg.receiver.borrow() } };
+    return IPv4Header::LENGTH + seg.header_length() + msg.sender->payload.size();
+  }
+
+  void send( const TCPMessage& msg, uint64_t now_us )
+  {
+    for ( const auto& piece : adapter_.split_to_mtu( msg ) ) {
+      send_datagram( piece, now_us );
+    }
+  }
+
+  // Next segment that has arrived by `now_us`, if any
+  std::optional<TCPMessage> receive( uint64_t now_us )
+  {
+    if ( in_flight_.empty() or in_flight_.front().first > now_us ) {
+      return {};
+    }
+    TCPMessage msg = std::move( in_flight_.front().second );
+    in_flight_.pop();
+    return msg;
+  }
+
+  uint64_t segments_sent() const { return segments_sent_; }
+  uint64_t queue_drops() const { return queue_drops_; }
+  uint64_t random_drops() const { return random_drops_; }
+
+private:
+  void send_datagram( const TCPMessage& msg, uint64_t now_us )
+  {
+    segments_sent_++;
+    const uint64_t size = wire_size( msg );
+    const uint64_t start_us = std::max( now_us, busy_until_us_ );
+    if ( ( start_us - now_us ) * config_.rate_bytes_per_ms / 1000 + size > config_.queue_bytes ) {
+      queue_drops_++;
+      return;
+    }
+    busy_until_us_ = start_us + size * 1000 / config_.rate_bytes_per_ms;
+    if ( std::bernoulli_distribution { config_.loss }( rd_ ) ) {
+      random_drops_++;
+      return;
+    }
+    in_flight_.emplace( busy_until_us_ + config_.delay_ms * 1000, copy( msg ) );
+  }
+
+  TCPMessage copy( const TCPMessage& msg ) const
+  {
+    if ( not config_.serialize ) {
+      return { TCPSenderMessage { msg.sender.get() }, TCPReceiverMessage { msg.receiver.get() } };
+    }
+    TCPSegment seg { .message = { msg.sender.borrow(), msg.receiver.borrow() } };
+    seg.compute_checksum( 0 );
+    TCPSegment parsed;
+    if ( not parse( parsed, serialize( seg ), 0 ) ) {
+      throw std::runtime_error( "segment failed to parse after serialization: " + seg.to_string() );
+    }
+    return std::move( parsed.message );
+  }
+
+  LinkConfig config_;
+  std::default_random_engine rd_;
+  TCPOverIPv4Adapter adapter_ {}; // splits super-segments to the MTU
+  uint64_t busy_until_us_ {};
+  std::queue<std::pair<uint64_t, TCPMessage>> in_flight_ {};
+  uint64_t segments_sent_ {};
+  uint64_t queue_drops_ {};
+  uint64_t random_drops_ {};
+};
+
+struct TransferResult
+{
+  uint64_t duration_ms {};
+  uint64_t segments_sent {};
+  uint64_t queue_drops {};
+  uint64_t random_drops {};
+  uint64_t acks_sent {}; // segments from the receiver back to the sender
+  uint64_t receive_capacity {}; // receiver's buffer size at the end (grows with autotuning)
+
+  double goodput_mbps( uint64_t bytes ) const
+  {
+    return 8 * static_cast<double>( bytes ) / static_cast<double>( duration_ms ) / 1000;
+  }
+};
+
+// Send `data` from a client TCPPeer to a server TCPPeer over a pair of simulated links, one millisecond
+// at a time, and check that it arrives intact. The client writes at most `write_bytes_per_ms` each
+// millisecond (by default, as much as its outbound stream will take).
+inline TransferResult run_transfer( const TCPConfig& client_config,
+                                    const TCPConfig& server_config,
+                                    const LinkConfig& link,
+                                    const std::string& data,
+                                    uint64_t seed,
+                                    uint64_t time_limit_ms = 600'000,
+                                    uint64_t write_bytes_per_ms = UINT64_MAX )
+{
+  TCPPeer client { client_config };
+  TCPPeer server { server_config };
+  SimulatedLink forward { link, seed };
+  SimulatedLink reverse { link, seed + 1 };
+
+  uint64_t now_ms = 0;
+  const auto to_server = [&]( const TCPMessage& msg ) { forward.send( msg, now_ms * 1000 ); };
+  const auto to_client = [&]( const TCPMessage& msg ) { reverse.send( msg, now_ms * 1000 ); };
+
+  server.outbound_writer().close();
+  uint64_t written = 0;
+  std::string received;
+  received.reserve( data.size() );
+
+  for ( ; now_ms < time_limit_ms; ++now_ms ) {
+    Writer& writer = client.outbound_writer();
+    if ( written < data.size() ) {
+      const uint64_t len
+        = std::min<uint64_t>( { writer.available_capacity(), data.size() - written, write_bytes_per_ms } );
+      writer.push( data.substr( written, len ) );
+      written += len;
+      if ( written == data.size() ) {
+        writer.close();
+      }
+    }
+    client.push( to_server );
+
+    while ( auto msg = forward.receive( now_ms * 1000 ) ) {
+      server.receive( std::move( *msg ), to_client );
+    }
+    while ( auto msg = reverse.receive( now_ms * 1000 ) ) {
+      client.receive( std::move( *msg ), to_server );
+    }
+
+    Reader& reader = server.inbound_reader();
+    while ( reader.bytes_buffered() ) {
+      received += reader.peek();
+      reader.pop( reader.peek().size() );
+    }
+    if ( reader.is_finished() ) {
+      break;
+    }
+
+    client.tick( 1, to_server );
+    server.tick( 1, to_client );
+  }
+
+  if ( not server.inbound_reader().is_finished() ) {
+    throw std::runtime_error( "transfer did not finish within " + std::to_string( time_limit_ms ) + " ms" );
+  }
+  if ( received != data ) {
+    throw std::runtime_error( "data received does not match data sent" );
+  }
+
+  return { now_ms,
+           forward.segments_sent(),
+           forward.queue_drops(),
+           forward.random_drops(),
+           reverse.segments_sent(),
+           server.receiver().writer().available_capacity() + server.receiver().reader().bytes_buffered() };
+}
@@ -0,0 +1,87 @@
+#include "common.hh"
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// A server peer that takes a SYN carrying `peer_mss` (if any), then sends `size` bytes. Returns the payload size
+// of each segment it sent after the handshake.
+vector<size_t> segments_after_syn( const TCPConfig& cfg, optional<uint16_t> peer_mss, size_t size )
+{
+  TCPPeer server { cfg };
+  vector<TCPMessage> sent;
+  const auto transmit = [&]( const TCPMessage& msg ) {
+    sent.push_back( { TCPSenderMessage { msg.sender.get() }, TCPReceiverMessage { msg.receiver.get() } } );
+  };
+
+  const Wrap32 client_isn { 1000 };
+  server.receive( { TCPSenderMessage { .seqno = client_isn, .SYN = true, .mss = peer_mss },
+                    TCPReceiverMessage { .window_size = UINT16_MAX } },
+                  transmit );
+  expect( sent.size() == 1 and sent.front().sender->SYN, "expected a SYN/ACK" );
+  server.receive( { TCPSenderMessage { .seqno = client_isn + 1 },
+                    TCPReceiverMessage { .ackno = cfg.isn + 1, .window_size = UINT16_MAX } },
+                  transmit );
+
+  sent.clear();
+  server.outbound_writer().push( string( size, 'x' ) );
+  server.push( transmit );
+
+  vector<size_t> sizes;
+  for ( const auto& msg : sent ) {
+    sizes.push_back( msg.sender->payload.size() );
+  }
+  return sizes;
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    // A peer's MSS is honored even when this side doesn't advertise one.
+    {
+      const auto sizes = segments_after_syn( TCPConfig {}, 536, 2000 );
+      expect( sizes == vector<size_t> { 536, 536, 536, 392 }, "segments exceed the peer's MSS" );
+    }
+
+    // A peer's MSS larger than what this side sends is not an invitation to send more.
+    {
+      const auto sizes = segments_after_syn( TCPConfig {}, 1460, 2000 );
+      expect( sizes == vector<size_t> { TCPConfig::MAX_PAYLOAD_SIZE, 2000 - TCPConfig::MAX_PAYLOAD_SIZE },
+              "segments exceed MAX_PAYLOAD_SIZE" );
+    }
+
+    // With no MSS negotiated by either side, segments keep their configured size.
+    {
+      const auto sizes = segments_after_syn( TCPConfig {}, {}, 2000 );
+      expect( sizes == vector<size_t> { TCPConfig::MAX_PAYLOAD_SIZE, 2000 - TCPConfig::MAX_PAYLOAD_SIZE },
+              "segments shrank without an MSS option" );
+    }
+
+    // If this side advertises an MSS and the peer sends none, assume the default (RFC 9293).
+    {
+      TCPConfig cfg;
+      cfg.mss = 1460;
+      const auto sizes = segments_after_syn( cfg, {}, 1000 );
+      expect( sizes == vector<size_t> { TCPConfig::DEFAULT_MSS, 1000 - TCPConfig::DEFAULT_MSS },
+              "segments exceed the default MSS" );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,161 @@
+#include "common.hh"
+#include "helpers.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+// Serialize a segment (checksummed against a zero pseudo-header) and parse it back
+TCPSegment round_trip( TCPSegment seg, uint8_t expected_header_length )
+{
+  if ( seg.header_length() != expected_header_length ) {
+    throw runtime_error( "header_length() = " + to_string( seg.header_length() ) + ", expected "
+                         + to_string( expected_header_length ) + " for " + seg.to_string() );
+  }
+  seg.compute_checksum( 0 );
+  TCPSegment parsed;
+  if ( not parse( parsed, serialize( seg ), 0 ) ) {
+    throw runtime_error( "segment failed to parse after serialization: " + seg.to_string() );
+  }
+  if ( parsed.message.sender->payload != seg.message.sender->payload ) {
+    throw runtime_error( "payload changed in round trip: " + parsed.to_string() );
+  }
+  return parsed;
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    const Wrap32 ackno { 4000000000 };
+    const auto block = [&]( uint32_t begin, uint32_t end ) { return SackBlock { ackno + begin, ackno + end }; };
+
+    {
+      TCPSegment seg { .message = { TCPSenderMessage { .payload = "hello" }, TCPReceiverMessage { ackno, 1000 } } };
+      const auto parsed = round_trip( seg, TCPSegment::HEADER_LENGTH );
+      expect( parsed.message.receiver->sack.empty(), "plain segment grew SACK blocks" );
+      expect( not parsed.message.sender->sack_permitted, "plain segment grew SACK-permitted" );
+    }
+
+    {
+      TCPSegment seg { .message = { TCPSenderMessage { .SYN = true, .sack_permitted = true }, {} } };
+      const auto parsed = round_trip( seg, TCPSegment::HEADER_LENGTH + 4 );
+      expect( parsed.message.sender->sack_permitted, "SACK-permitted lost in round trip" );
+    }
+
+    {
+      TCPSegment seg { .message = { TCPSenderMessage { .payload = "data" }, TCPReceiverMessage { ackno, 1000 } } };
+      seg.message.receiver->sack = { block( 10, 20 ), block( 30, 45 ), block( UINT32_MAX - 5, 5 ) };
+      const auto parsed = round_trip( seg, TCPSegment::HEADER_LENGTH + 4 + 3 * 8 );
+      expect( parsed.message.receiver->sack == seg.message.receiver->sack, "SACK blocks changed in round trip" );
+    }
+
+    {
+      TCPSegment seg { .message = { {}, TCPReceiverMessage { ackno, 1000 } } };
+      for ( uint32_t i = 0; i < 6; i++ ) {
+        seg.message.receiver->sack.push_back( block( 100 * i, 100 * i + 50 ) );
+      }
+      const auto parsed = round_trip( seg, TCPSegment::HEADER_LENGTH + 4 + 4 * 8 );
+      expect( parsed.message.receiver->sack.size() == TCPReceiverMessage::MAX_SACK_BLOCKS,
+              "more than MAX_SACK_BLOCKS blocks sent" );
+    }
+
+    {
+      TCPSegment seg { .message = { TCPSenderMessage { .SYN = true, .sack_permitted = true }, {} } };
+      seg.message.receiver->sack = { block( 10, 20 ) };
+      const auto parsed = round_trip( seg, TCPSegment::HEADER_LENGTH + 4 );
+      expect( parsed.message.receiver->sack.empty(), "SACK blocks sent without an ackno" );
+    }
+
+    {
+      TCPSegment seg {
+        .message = { TCPSenderMessage { .SYN = true, .sack_permitted = true, .window_scale = 7 }, {} } };
+      const auto parsed = round_trip( seg, TCPSegment::HEADER_LENGTH + 4 + 4 );
+      expect( parsed.message.sender->window_scale == 7, "window scale changed in round trip" );
+      expect( parsed.message.sender->sack_permitted, "SACK-permitted lost next to window scale" );
+    }
+
+    {
+      TCPSegment seg { .message = { TCPSenderMessage { .payload = "x", .window_scale = 7 }, {} } };
+      const auto parsed = round_trip( seg, TCPSegment::HEADER_LENGTH );
+      expect( not parsed.message.sender->window_scale.has_value(), "window scale sent without SYN" );
+    }
+
+    {
+      TCPSegment seg { .message = {
+                         TCPSenderMessage { .SYN = true, .sack_permitted = true, .window_scale = 7, .mss = 1460 }, {} } };
+      const auto parsed = round_trip( seg, TCPSegment::HEADER_LENGTH + 4 + 4 + 4 );
+      expect( parsed.message.sender->mss == 1460, "MSS changed in round trip" );
+      expect( parsed.message.sender->window_scale == 7, "window scale lost next to MSS" );
+    }
+
+    {
+      TCPSegment seg {
+        .message = { TCPSenderMessage { .SYN = true, .sack_permitted = true, .timestamp = 12345 }, {} } };
+      seg.message.receiver->timestamp_echo = 999;
+      const auto parsed = round_trip( seg, TCPSegment::HEADER_LENGTH + 4 + 12 );
+      expect( parsed.message.sender->timestamp == 12345, "TSval changed in round trip" );
+      expect( not parsed.message.receiver->timestamp_echo.has_value(), "TSecr kept without an ackno" );
+      expect( parsed.message.sender->sack_permitted, "SACK-permitted lost next to timestamps" );
+    }
+
+    {
+      TCPSegment seg { .message = { TCPSenderMessage { .payload = "data", .timestamp = UINT32_MAX },
+                                    TCPReceiverMessage { ackno, 1000 } } };
+      seg.message.receiver->timestamp_echo = 7;
+      const auto parsed = round_trip( seg, TCPSegment::HEADER_LENGTH + 12 );
+      expect( parsed.message.sender->timestamp == UINT32_MAX, "TSval changed in round trip" );
+      expect( parsed.message.receiver->timestamp_echo == 7, "TSecr changed in round trip" );
+    }
+
+    {
+      TCPSegment seg { .message = { TCPSenderMessage { .timestamp = 1 }, TCPReceiverMessage { ackno, 1000 } } };
+      for ( uint32_t i = 0; i < 4; i++ ) {
+        seg.message.receiver->sack.push_back( block( 100 * i, 100 * i + 50 ) );
+      }
+      const auto parsed = round_trip( seg, TCPSegment::HEADER_LENGTH + 12 + 4 + 3 * 8 );
+      expect( parsed.message.receiver->sack.size() == TCPReceiverMessage::MAX_SACK_BLOCKS_WITH_TIMESTAMPS,
+              "more than three SACK blocks sent next to timestamps" );
+      expect( parsed.message.receiver->timestamp_echo == 0, "TSecr should default to 0" );
+    }
+
+    {
+      TCPSegment seg { .message = { TCPSenderMessage { .SYN = true,
+                                                       .sack_permitted = true,
+                                                       .window_scale = 7,
+                                                       .mss = 1460,
+                                                       .timestamp = 1 },
+                                    TCPReceiverMessage { ackno, 1000 } } };
+      seg.message.receiver->sack = { block( 10, 20 ), block( 30, 40 ), block( 50, 60 ) };
+      const auto parsed = round_trip( seg, TCPSegment::HEADER_LENGTH + 4 + 4 + 4 + 12 + 4 + 8 );
+      expect( parsed.message.receiver->sack.size() == 1, "SACK blocks overflowed the 40 bytes of options" );
+      expect( parsed.message.receiver->sack.front() == block( 10, 20 ), "the first SACK block should be kept" );
+      expect( parsed.message.sender->mss == 1460, "MSS lost next to SACK blocks" );
+    }
+
+    {
+      TCPSegment seg { .message = {
+                         TCPSenderMessage { .SYN = true, .sack_permitted = true, .window_scale = 7, .mss = 1460 },
+                         TCPReceiverMessage { ackno, 1000 } } };
+      for ( uint32_t i = 0; i < 4; i++ ) {
+        seg.message.receiver->sack.push_back( block( 100 * i, 100 * i + 50 ) );
+      }
+      const auto parsed = round_trip( seg, TCPSegment::HEADER_LENGTH + 4 + 4 + 4 + 4 + 3 * 8 );
+      expect( parsed.message.receiver->sack.size() == 3, "SACK blocks overflowed the 40 bytes of options" );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
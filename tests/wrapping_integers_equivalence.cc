@@ -0,0 +1,92 @@
+#include "random.hh"
+#include "wrapping_integers.hh"
+#include "wrapping_integers_reference.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// unwrap is usable in constant expressions
+static_assert( Wrap32 { 5 }.unwrap( Wrap32 { 0 }, 0 ) == 5 );
+static_assert( Wrap32 { 0 }.unwrap( Wrap32 { 1 }, 0 ) == ( 1UL << 32 ) - 1 );
+static_assert( Wrap32 { 0 }.unwrap( Wrap32 { 0 }, UINT64_MAX ) == UINT64_MAX - UINT32_MAX );
+static_assert( Wrap32::wrap( 3UL << 32 | 17, Wrap32 { 9 } ).unwrap( Wrap32 { 9 }, 3UL << 32 )
+               == ( 3UL << 32 | 17 ) );
+
+namespace {
+
+uint64_t checks = 0;
+
+void check( uint32_t raw_value, uint32_t zero_point, uint64_t checkpoint )
+{
+  const uint64_t expected = reference_unwrap( raw_value, zero_point, checkpoint );
+  const uint64_t actual = Wrap32 { raw_value }.unwrap( Wrap32 { zero_point }, checkpoint );
+  checks++;
+  if ( actual != expected ) {
+    throw runtime_error( "unwrap( raw=" + to_string( raw_value ) + ", zero=" + to_string( zero_point )
+                         + ", checkpoint=" + to_string( checkpoint ) + " ) returned " + to_string( actual )
+                         + ", expected " + to_string( expected ) );
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    uniform_int_distribution<uint64_t> dist64;
+    uniform_int_distribution<uint32_t> dist32;
+    uniform_int_distribution<int64_t> near( -4096, 4096 );
+
+    // Random inputs over the whole domain
+    for ( size_t i = 0; i < 20'000; i++ ) {
+      check( dist32( rd ), dist32( rd ), dist64( rd ) );
+    }
+
+    // Checkpoints near the edges: 0, 2^64, multiples of 2^32 and the halfway points between them
+    const uint64_t two32 = 1UL << 32;
+    const vector<uint64_t> anchors { 0, UINT64_MAX, two32, 2 * two32, UINT64_MAX - two32 + 1, two32 / 2,
+                                     two32 + two32 / 2, UINT64_MAX - two32 / 2, dist64( rd ) & ~( two32 - 1 ) };
+    for ( const uint64_t anchor : anchors ) {
+      for ( size_t i = 0; i < 2'000; i++ ) {
+        check( dist32( rd ), dist32( rd ), anchor + static_cast<uint64_t>( near( rd ) ) );
+      }
+    }
+
+    // Values exactly 2^31 away from the checkpoint (a tie between two candidates), and just either side of it
+    for ( size_t i = 0; i < 4'000; i++ ) {
+      const uint64_t checkpoint = i < 2'000 ? dist64( rd ) : static_cast<uint64_t>( near( rd ) );
+      const uint32_t zero_point = dist32( rd );
+      for ( const int64_t step : { -1, 0, 1 } ) {
+        const uint32_t offset = static_cast<uint32_t>( checkpoint ) + ( 1U << 31 ) + static_cast<uint32_t>( step );
+        check( zero_point + offset, zero_point, checkpoint );
+        check( zero_point + offset, zero_point, UINT64_MAX - checkpoint );
+      }
+    }
+
+    // Every value in a window around each edge checkpoint (wrapping_integers_speed_test sweeps a wider one)
+    for ( const uint64_t checkpoint : anchors ) {
+      const uint32_t zero_point = dist32( rd );
+      for ( uint64_t n = 0; n < 4096; n++ ) {
+        check( zero_point + static_cast<uint32_t>( checkpoint - 2048 + n ), zero_point, checkpoint );
+        const uint64_t halfway = checkpoint + ( 1U << 31 ) - 2048 + n;
+        check( zero_point + static_cast<uint32_t>( halfway ), zero_point, checkpoint );
+      }
+    }
+
+    cout << "unwrap matched the reference on " << checks << " inputs\n";
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// The original Wrap32::unwrap: build the three candidates around the checkpoint, sort them by distance (ties go
+// to the smaller value) and take the first. Kept as the reference for the equivalence and speed tests.
+inline uint64_t reference_unwrap( uint32_t raw_value, uint32_t zero_point, uint64_t checkpoint )
+{
+  constexpr uint64_t mod = static_cast<uint64_t>( 1 ) << 32;
+  const uint64_t temp = static_cast<uint64_t>( raw_value ) - static_cast<uint64_t>( zero_point );
+  const uint64_t rest1 = temp % mod;
+  const uint64_t rest2 = checkpoint % mod;
+  const uint64_t ans1 = checkpoint - ( rest2 - rest1 );
+  const uint64_t ans2 = ans1 + mod;
+  const uint64_t ans3 = ans1 - mod;
+  auto distance = []( uint64_t a, uint64_t b ) { return a < b ? b - a : a - b; };
+  std::vector<std::array<uint64_t, 2>> candidate { { distance( ans1, checkpoint ), ans1 },
+                                                   { distance( ans2, checkpoint ), ans2 },
+                                                   { distance( ans3, checkpoint ), ans3 } };
+  std::ranges::sort( candidate );
+  return candidate[0][1];
+}
@@ -0,0 +1,113 @@
+#include "wrapping_integers.hh"
+#include "wrapping_integers_reference.hh"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+struct Input
+{
+  uint32_t raw_value;
+  uint32_t zero_point;
+  uint64_t checkpoint;
+};
+
+// Runs `unwrap` over every input, `rounds` times; returns the nanoseconds per call and a checksum of the results
+template<typename Unwrap>
+pair<double, uint64_t> time_unwrap( const vector<Input>& inputs, size_t rounds, Unwrap&& unwrap )
+{
+  uint64_t checksum = 0;
+  const auto start_time = steady_clock::now();
+  for ( size_t r = 0; r < rounds; r++ ) {
+    for ( const auto& in : inputs ) {
+      checksum += unwrap( in );
+    }
+  }
+  const auto stop_time = steady_clock::now();
+  const auto elapsed = duration_cast<duration<double, nano>>( stop_time - start_time );
+  return { elapsed.count() / static_cast<double>( inputs.size() * rounds ), checksum };
+}
+
+void speed_test( fstream& debug_output, size_t input_count, size_t rounds, size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  uniform_int_distribution<uint32_t> dist32;
+  uniform_int_distribution<uint64_t> dist64;
+  vector<Input> inputs;
+  inputs.reserve( input_count );
+  for ( size_t i = 0; i < input_count; i++ ) {
+    inputs.push_back( { dist32( rd ), dist32( rd ), dist64( rd ) } );
+  }
+
+  const auto [reference_ns, reference_sum] = time_unwrap( inputs, rounds, []( const Input& in ) {
+    return reference_unwrap( in.raw_value, in.zero_point, in.checkpoint );
+  } );
+  const auto [unwrap_ns, unwrap_sum] = time_unwrap( inputs, rounds, []( const Input& in ) {
+    return Wrap32 { in.raw_value }.unwrap( Wrap32 { in.zero_point }, in.checkpoint );
+  } );
+
+  if ( reference_sum != unwrap_sum ) {
+    throw runtime_error( "Wrap32::unwrap disagrees with the reference implementation" );
+  }
+
+  cout << "Wrap32::unwrap over " << input_count * rounds << " calls: " << fixed << setprecision( 2 ) << unwrap_ns
+       << " ns/call (reference " << reference_ns << " ns/call, " << reference_ns / unwrap_ns << "x).\n";
+  debug_output << "        Wrap32::unwrap:  " << fixed << setprecision( 2 ) << setw( 6 ) << unwrap_ns
+               << " ns/call (reference " << reference_ns << " ns/call)\n";
+
+  if ( unwrap_ns > 20 ) {
+    throw runtime_error( "Wrap32::unwrap did not meet maximum time of 20 ns per call" );
+  }
+}
+
+// The full-size version of the edge sweep in wrapping_integers_equivalence: every value within 2^15 of each
+// edge checkpoint, and of the point halfway to the next wrap, must unwrap exactly as the reference does
+void sweep_edges()
+{
+  const uint64_t two32 = 1UL << 32;
+  const uint32_t zero_point = 0x9e3779b9;
+  for ( const uint64_t checkpoint : { uint64_t { 0 }, UINT64_MAX, two32, 2 * two32, UINT64_MAX - two32 + 1,
+                                      two32 / 2, two32 + two32 / 2, UINT64_MAX - two32 / 2 } ) {
+    for ( uint64_t n = 0; n < 65536; n++ ) {
+      for ( const uint64_t value : { checkpoint - 32768 + n, checkpoint + ( 1U << 31 ) - 32768 + n } ) {
+        const uint32_t raw_value = zero_point + static_cast<uint32_t>( value );
+        if ( Wrap32 { raw_value }.unwrap( Wrap32 { zero_point }, checkpoint )
+             != reference_unwrap( raw_value, zero_point, checkpoint ) ) {
+          throw runtime_error( "Wrap32::unwrap disagrees with the reference near checkpoint "
+                               + to_string( checkpoint ) );
+        }
+      }
+    }
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    fstream debug_output;
+    debug_output.open( "/dev/tty" );
+    sweep_edges();
+    speed_test( debug_output, 1 << 16, 200, 1066 );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -1,6 +1,8 @@
 #include "eventloop.hh"
 #include "exception.hh"
 
+#include <algorithm>
+#include <climits>
 #include <cstring>
 #include <iostream>
 #include <sys/socket.h>
@@ -38,6 +40,10 @@ EventLoop::FDRule::FDRule( BasicRule&& base,
   , error( move( s_error ) )
 {}
 
+EventLoop::TimerRule::TimerRule( BasicRule&& base, DeadlineT s_deadline )
+  : BasicRule( move( base ) ), deadline( move( s_deadline ) )
+{}
+
 EventLoop::RuleHandle EventLoop::add_rule( size_t category_id,
                                            FileDescriptor& fd,
                                            Direction direction,
@@ -69,6 +75,20 @@ EventLoop::RuleHandle EventLoop::add_rule( const size_t category_id,
   return RuleHandle { _non_fd_rules.back() };
 }
 
+EventLoop::RuleHandle EventLoop::add_timer( const size_t category_id,
+                                            const DeadlineT& deadline,
+                                            const CallbackT& callback )
+{
+  if ( category_id >= _rule_categories.size() ) {
+    throw out_of_range( "bad category_id" );
+  }
+
+  _timer_rules.emplace_back(
+    make_shared<TimerRule>( BasicRule { category_id, [] { return true; }, callback }, deadline ) );
+
+  return RuleHandle { _timer_rules.back() };
+}
+
 void EventLoop::RuleHandle::cancel()
 {
   const shared_ptr<BasicRule> rule_shared_ptr = rule_weak_ptr_.lock();
@@ -112,6 +132,27 @@ EventLoop::Result EventLoop::wait_next_event( const int timeout_ms )
     }
   }
 
+  // next, the timers: serve one that is due, or else wait no longer than the earliest deadline
+  int poll_timeout_ms = timeout_ms;
+  shared_ptr<TimerRule> next_timer {};
+  for ( auto it = _timer_rules.begin(); it != _timer_rules.end(); ) {
+    if ( ( *it )->cancel_requested ) {
+      it = _timer_rules.erase( it );
+      continue;
+    }
+
+    const auto deadline = ( *it )->deadline();
+    if ( deadline.has_value() and *deadline == 0 ) {
+      ( *it )->callback();
+      return Result::Success; /* only serve one rule on each iteration */
+    }
+    if ( deadline.has_value() and ( poll_timeout_ms < 0 or *deadline < static_cast<uint64_t>( poll_timeout_ms ) ) ) {
+      poll_timeout_ms = static_cast<int>( min<uint64_t>( *deadline, INT_MAX ) );
+      next_timer = *it;
+    }
+    ++it;
+  }
+
   // now the file-descriptor-related rules. poll any "interested" file descriptors
   vector<pollfd> pollfds {};
   pollfds.reserve( _fd_rules.size() );
@@ -159,7 +200,11 @@ EventLoop::Result EventLoop::wait_next_event( const int timeout_ms )
   }
 
   // call poll -- wait until one of the fds satisfies one of the rules (writeable/readable)
-  if ( 0 == CheckSystemCall( "poll", ::poll( pollfds.data(), pollfds.size(), timeout_ms ) ) ) {
+  if ( 0 == CheckSystemCall( "poll", ::poll( pollfds.data(), pollfds.size(), poll_timeout_ms ) ) ) {
+    if ( next_timer ) {
+      next_timer->callback();
+      return Result::Success;
+    }
     return Result::Timeout;
   }
 
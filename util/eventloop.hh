@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <list>
 #include <memory>
+#include <optional>
 #include <poll.h>
 
 #include "file_descriptor.hh"
@@ -21,6 +23,7 @@ public:
 private:
   using CallbackT = std::function<void( void )>;
   using InterestT = std::function<bool( void )>;
+  using DeadlineT = std::function<std::optional<uint64_t>( void )>;
 
   struct RuleCategory
   {
@@ -51,9 +54,17 @@ private:
     unsigned int service_count() const;
   };
 
+  struct TimerRule : public BasicRule
+  {
+    DeadlineT deadline; //!< Milliseconds until the callback is due, or empty if the timer is disarmed
+
+    TimerRule( BasicRule&& base, DeadlineT s_deadline );
+  };
+
   std::vector<RuleCategory> _rule_categories {};
   std::list<std::shared_ptr<FDRule>> _fd_rules {};
   std::list<std::shared_ptr<BasicRule>> _non_fd_rules {};
+  std::list<std::shared_ptr<TimerRule>> _timer_rules {};
 
 public:
   EventLoop() { _rule_categories.reserve( 64 ); }
@@ -93,6 +104,10 @@ public:
   RuleHandle
   add_rule( size_t category_id, const CallbackT& callback, const InterestT& interest = [] { return true; } );
 
+  //! Adds a timer: `callback` runs once `deadline` (re-evaluated on every wait) reaches zero milliseconds.
+  //! An armed timer shortens the poll timeout, so the loop wakes when it is due rather than at the next event.
+  RuleHandle add_timer( size_t category_id, const DeadlineT& deadline, const CallbackT& callback );
+
   //! Calls [poll(2)](\ref man2::poll) and then executes callback for each ready fd.
   Result wait_next_event( int timeout_ms );
 
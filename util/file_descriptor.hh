@@ -3,6 +3,7 @@
 #include "ref.hh"
 #include <cstddef>
 #include <memory>
+#include <span>
 #include <vector>
 
 // A reference-counted handle to a file descriptor
@@ -64,6 +65,7 @@ public:
   // Read into `buffer`
   void read( std::string& buffer );
   void read( std::vector<std::string>& buffers );
+  size_t read( const std::vector<std::span<char>>& buffers ); // readv into caller-owned memory, returns bytes read
 
   // Attempt to write a buffer
   // returns number of bytes written
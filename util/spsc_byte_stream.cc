@@ -0,0 +1,156 @@
+#include "spsc_byte_stream.hh"
+
+#include "exception.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <poll.h>
+#include <string>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using namespace std;
+
+SPSCByteStream::SPSCByteStream( uint64_t capacity )
+  : capacity_( capacity )
+  , buffer_( make_unique<char[]>( capacity ) ) // NOLINT(*-avoid-c-arrays)
+  , readable_event_( CheckSystemCall( "eventfd", eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) ) )
+  , writable_event_( CheckSystemCall( "eventfd", eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) ) )
+{}
+
+uint64_t SPSCByteStream::push( string_view data )
+{
+  const uint64_t tail = tail_.load( memory_order_relaxed );
+  const uint64_t head = head_.load( memory_order_acquire );
+  const uint64_t len = min<uint64_t>( data.size(), capacity_ - ( tail - head ) );
+  if ( len == 0 or closed_.load( memory_order_relaxed ) ) {
+    return 0;
+  }
+
+  const uint64_t pos = tail % capacity_;
+  const uint64_t first = min( len, capacity_ - pos );
+  memcpy( buffer_.get() + pos, data.data(), first );
+  memcpy( buffer_.get(), data.data() + first, len - first );
+
+  tail_.store( tail + len, memory_order_seq_cst );
+
+  // If the reader had drained everything we had published so far, it may be asleep. Both this store/load pair
+  // and the reader's (pop, then wait_readable) must be seq_cst: then at least one side sees the other's store,
+  // so either we signal or the reader doesn't sleep.
+  if ( head_.load( memory_order_seq_cst ) == tail ) {
+    signal( readable_event_ );
+  }
+  return len;
+}
+
+void SPSCByteStream::close()
+{
+  closed_.store( true, memory_order_seq_cst );
+  signal( readable_event_ );
+  signal( writable_event_ );
+}
+
+uint64_t SPSCByteStream::available_capacity() const
+{
+  return capacity_ - ( tail_.load( memory_order_relaxed ) - head_.load( memory_order_acquire ) );
+}
+
+string_view SPSCByteStream::peek() const
+{
+  const uint64_t head = head_.load( memory_order_relaxed );
+  const uint64_t tail = tail_.load( memory_order_acquire );
+  if ( head == tail ) {
+    return {};
+  }
+  const uint64_t pos = head % capacity_;
+  return { buffer_.get() + pos, min( tail - head, capacity_ - pos ) };
+}
+
+void SPSCByteStream::pop( uint64_t len )
+{
+  const uint64_t head = head_.load( memory_order_relaxed );
+  len = min( len, tail_.load( memory_order_acquire ) - head );
+  if ( len == 0 ) {
+    return;
+  }
+
+  head_.store( head + len, memory_order_seq_cst );
+
+  // If the buffer was full before this pop, the writer may be asleep (seq_cst, pairing with wait_writable).
+  if ( tail_.load( memory_order_seq_cst ) - head == capacity_ ) {
+    signal( writable_event_ );
+  }
+}
+
+uint64_t SPSCByteStream::bytes_buffered() const
+{
+  return tail_.load( memory_order_acquire ) - head_.load( memory_order_relaxed );
+}
+
+bool SPSCByteStream::is_finished() const
+{
+  return is_closed() and bytes_buffered() == 0;
+}
+
+void SPSCByteStream::wait_readable()
+{
+  // seq_cst re-check of the writer's index, pairing with push() (see there); an acquire load could still see
+  // the old tail after the writer has decided not to signal.
+  const bool empty = tail_.load( memory_order_seq_cst ) == head_.load( memory_order_relaxed );
+  if ( empty and not closed_.load( memory_order_seq_cst ) ) {
+    wait( readable_event_ );
+  }
+}
+
+void SPSCByteStream::wait_writable()
+{
+  // seq_cst re-check of the reader's index, pairing with pop()
+  const bool full = tail_.load( memory_order_relaxed ) - head_.load( memory_order_seq_cst ) == capacity_;
+  if ( full and not closed_.load( memory_order_seq_cst ) ) {
+    wait( writable_event_ );
+  }
+}
+
+void SPSCByteStream::rearm_readable()
+{
+  consume( readable_event_ );
+  // seq_cst re-check, pairing with push() as in wait_readable(): a push that didn't signal is seen here
+  const bool empty = tail_.load( memory_order_seq_cst ) == head_.load( memory_order_relaxed );
+  if ( not empty or closed_.load( memory_order_seq_cst ) ) {
+    signal( readable_event_ );
+  }
+}
+
+void SPSCByteStream::rearm_writable()
+{
+  consume( writable_event_ );
+  // seq_cst re-check, pairing with pop() as in wait_writable()
+  const bool full = tail_.load( memory_order_relaxed ) - head_.load( memory_order_seq_cst ) == capacity_;
+  if ( not full ) {
+    signal( writable_event_ );
+  }
+}
+
+void SPSCByteStream::signal( FileDescriptor& event )
+{
+  const uint64_t one = 1;
+  CheckSystemCall( "write", static_cast<int>( ::write( event.fd_num(), &one, sizeof( one ) ) ) );
+}
+
+void SPSCByteStream::wait( FileDescriptor& event )
+{
+  pollfd pfd { event.fd_num(), POLLIN, 0 };
+  CheckSystemCall( "poll", ::poll( &pfd, 1, -1 ) );
+
+  uint64_t count {};
+  if ( ::read( event.fd_num(), &count, sizeof( count ) ) < 0 and errno != EAGAIN ) {
+    throw unix_error { "read" };
+  }
+}
+
+void SPSCByteStream::consume( FileDescriptor& event )
+{
+  // Through FileDescriptor (not ::read), so the EventLoop sees the rule serviced its fd
+  string count( sizeof( uint64_t ), '\0' );
+  event.read( count );
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "file_descriptor.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+// A fixed-capacity byte stream shared by exactly one writer thread and one reader thread.
+//
+// The bytes live in a ring buffer allocated once at construction. The writer only advances
+// `tail_` and the reader only advances `head_`, so neither side takes a lock or makes a
+// syscall on the fast path. When one side runs out of work, it can sleep on an eventfd
+// (readable_fd() / writable_fd(), both usable with poll() or the EventLoop); the other
+// side signals it only on the empty->non-empty or full->non-full transition.
+class SPSCByteStream
+{
+public:
+  explicit SPSCByteStream( uint64_t capacity );
+
+  // Writer-thread interface
+  uint64_t push( std::string_view data ); // Copy in as much of `data` as fits; returns bytes accepted
+  void close();                           // Signal that nothing more will be written (or read, from the reader)
+  uint64_t available_capacity() const;    // How many bytes can be pushed right now?
+  void wait_writable();                   // Block until space may be available (or the stream is closed)
+
+  // Reader-thread interface
+  std::string_view peek() const; // Longest contiguous run of buffered bytes
+  void pop( uint64_t len );      // Remove `len` bytes
+  uint64_t bytes_buffered() const;
+  bool is_finished() const; // Closed and fully popped?
+  void wait_readable();     // Block until bytes (or EOF) may be available
+
+  bool is_closed() const { return closed_.load( std::memory_order_acquire ); }
+
+  // eventfds that become readable when the other side has made progress
+  FileDescriptor& readable_fd() { return readable_event_; }
+  FileDescriptor& writable_fd() { return writable_event_; }
+
+  // For a side driven by an EventLoop instead of wait_readable() / wait_writable(): call after each round of
+  // work. Consumes the wakeup, then re-arms it if bytes or EOF (space) are still available, so the fd stays
+  // readable for as long as there is work, like a socket's POLLIN (POLLOUT).
+  void rearm_readable();
+  void rearm_writable();
+
+private:
+  uint64_t capacity_;
+  std::unique_ptr<char[]> buffer_; // NOLINT(*-avoid-c-arrays)
+
+  alignas( 64 ) std::atomic<uint64_t> head_ { 0 }; // total bytes popped (written by the reader only)
+  alignas( 64 ) std::atomic<uint64_t> tail_ { 0 }; // total bytes pushed (written by the writer only)
+  alignas( 64 ) std::atomic<bool> closed_ { false };
+
+  FileDescriptor readable_event_;
+  FileDescriptor writable_event_;
+
+  static void signal( FileDescriptor& event );
+  static void wait( FileDescriptor& event );
+  static void consume( FileDescriptor& event );
+};
@@ -3,8 +3,10 @@
 #include "address.hh"
 #include "wrapping_integers.hh"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 
 //! Config for TCP sender and receiver
 class TCPConfig
@@ -12,13 +14,63 @@ class TCPConfig
 public:
   static constexpr size_t DEFAULT_CAPACITY = 64000; //!< Default capacity
   static constexpr size_t MAX_PAYLOAD_SIZE = 1000;  //!< Conservative max payload size for real Internet
+  static constexpr size_t RECV_MAX_DFLT = 6291456;  //!< Default cap on an autotuned receive buffer (as in Linux)
+  static constexpr size_t SEND_MAX_DFLT = 4194304;  //!< Default cap on an autosized send buffer (as in Linux)
   static constexpr uint16_t TIMEOUT_DFLT = 1000;    //!< Default re-transmit timeout is 1 second
   static constexpr unsigned MAX_RETX_ATTEMPTS = 8;  //!< Maximum re-transmit attempts before giving up
+  static constexpr uint64_t MIN_RTO_DFLT = 200;     //!< Default lower bound on the adaptive RTO (as in Linux)
+  static constexpr uint64_t MAX_RTO_DFLT = 60000;   //!< Default upper bound on the adaptive RTO (RFC 6298)
+  static constexpr uint8_t MAX_WINDOW_SCALE = 14;   //!< Largest window shift allowed by RFC 7323
+  static constexpr uint16_t DEFAULT_MSS = 536;      //!< MSS assumed if the peer's SYN has no MSS option (RFC 9293)
+  static constexpr uint16_t ACK_DELAY_DFLT = 40;    //!< Default delayed-ack timer, in milliseconds (as in Linux)
 
-  uint16_t rt_timeout = TIMEOUT_DFLT;      //!< Initial value of the retransmission timeout, in milliseconds
-  size_t recv_capacity = DEFAULT_CAPACITY; //!< Receive capacity, in bytes
-  size_t send_capacity = DEFAULT_CAPACITY; //!< Sender capacity, in bytes
-  Wrap32 isn { 137 };                      //!< Default initial sequence number
+  //! Congestion control algorithm used by the sender
+  enum class Congestion : uint8_t
+  {
+    None,    //!< No congestion window: send whatever the peer's window allows
+    Reno,    //!< RFC 5681 slow start and congestion avoidance
+    NewReno, //!< Reno with RFC 6582 fast recovery
+    Cubic,   //!< RFC 9438 CUBIC
+    BBR,     //!< Model-based: paces at the estimated bottleneck bandwidth, ignores random loss
+  };
+
+  uint16_t rt_timeout = TIMEOUT_DFLT;       //!< Initial value of the retransmission timeout, in milliseconds
+  size_t recv_capacity = DEFAULT_CAPACITY;  //!< Receive capacity, in bytes
+  size_t send_capacity = DEFAULT_CAPACITY;  //!< Sender capacity, in bytes
+  Wrap32 isn { 137 };                       //!< Default initial sequence number
+  Congestion congestion = Congestion::None; //!< Congestion control algorithm
+  bool adaptive_rto = false;                //!< Derive the RTO from measured RTTs (RFC 6298), not rt_timeout
+  uint64_t min_rto_ms = MIN_RTO_DFLT;       //!< Lower bound on the RTO when adaptive_rto is set
+  uint64_t max_rto_ms = MAX_RTO_DFLT;       //!< Upper bound on the adaptive RTO, including back-off
+  bool sack = false;                        //!< Negotiate selective acknowledgments (RFC 2018) on the SYN
+  bool window_scaling = false;              //!< Negotiate window scaling (RFC 7323) so windows can exceed 64 KiB
+  bool timestamps = false;                  //!< Negotiate timestamps (RFC 7323) for RTT samples and PAWS
+  std::optional<uint16_t> mss {};           //!< If set, advertise this MSS (the peer's MSS is always honored)
+  uint16_t gso_segments = 1;                //!< Send up to this many MSS per message, for the adapter to split
+  bool pacing = false;                      //!< Spread segments over the RTT instead of sending the window at once
+  uint64_t pacing_rate = 0;                 //!< Pacing rate in bytes/s; 0 estimates it from cwnd (or window) / SRTT
+  bool nagle = false;                       //!< Hold back sub-MSS segments while data is unacknowledged (RFC 896)
+  bool delayed_ack = false;                 //!< Ack every second segment or after ack_delay ms (RFC 1122)
+  uint16_t ack_delay = ACK_DELAY_DFLT;      //!< Longest a delayed ack waits for another segment or outgoing data
+  bool recv_autotune = false;               //!< Grow the receive buffer as the application drains it (tcp_rmem)
+  size_t recv_capacity_max = RECV_MAX_DFLT; //!< Largest the autotuned receive buffer may grow, in bytes
+  bool send_autotune = false;               //!< Grow the send buffer to two windows of data (tcp_wmem)
+  size_t send_capacity_max = SEND_MAX_DFLT; //!< Largest the autosized send buffer may grow, in bytes
+
+  //! Window shift to advertise on the SYN if window scaling is enabled: the smallest that covers the largest
+  //! receive buffer (recv_capacity, or recv_capacity_max when autotuning)
+  std::optional<uint8_t> window_scale() const
+  {
+    if ( not window_scaling ) {
+      return {};
+    }
+    const size_t capacity = recv_autotune ? std::max( recv_capacity, recv_capacity_max ) : recv_capacity;
+    uint8_t shift = 0;
+    while ( shift < MAX_WINDOW_SCALE and ( capacity >> shift ) > UINT16_MAX ) {
+      shift++;
+    }
+    return shift;
+  }
 };
 
 //! Config for classes derived from FdAdapter
@@ -30,4 +82,7 @@ public:
 
   uint16_t loss_rate_dn = 0; //!< Downlink loss rate (for LossyFdAdapter)
   uint16_t loss_rate_up = 0; //!< Uplink loss rate (for LossyFdAdapter)
+
+  std::optional<uint16_t> mtu {}; //!< Link MTU; if set, the connection negotiates an MSS that fits in it
+  uint16_t gso_segments = 1;      //!< Largest super-segment the adapter will split, in MSS-sized segments
 };
@@ -3,6 +3,7 @@
 #include "eventloop.hh"
 #include "file_descriptor.hh"
 #include "socket.hh"
+#include "spsc_byte_stream.hh"
 #include "tcp_config.hh"
 #include "tcp_peer.hh"
 #include "tuntap_adapter.hh"
@@ -10,6 +11,8 @@
 #include <atomic>
 #include <cstdint>
 #include <optional>
+#include <string>
+#include <string_view>
 #include <thread>
 
 //! Multithreaded wrapper around TCPPeer that approximates the Unix sockets API
@@ -17,8 +20,15 @@ template<TCPDatagramAdapter AdaptT>
 class TCPMinnowSocket : public LocalStreamSocket
 {
 public:
+  //! How bytes move between the owner thread and the TCPPeer thread
+  enum class DataPath : uint8_t
+  {
+    SocketPair, //!< Through an AF_UNIX socketpair: the owner reads and writes this socket's fd
+    SPSC,       //!< Through a pair of SPSCByteStreams: the owner calls read_direct() and write_direct()
+  };
+
   //! Construct from the interface that the TCPPeer thread will use to read and write datagrams
-  explicit TCPMinnowSocket( AdaptT&& datagram_interface );
+  explicit TCPMinnowSocket( AdaptT&& datagram_interface, DataPath data_path = DataPath::SocketPair );
 
   //! Close socket, and wait for TCPPeer to finish
   //! \note Calling this function is only advisable if the socket has reached EOF,
@@ -53,9 +63,38 @@ public:
   void set_reuseaddr() = delete;
   //!@}
 
+  //! Turn Nagle's algorithm off (true) or back on (false), like TCP_NODELAY
+  //! \note The TCPConfig's `nagle` flag sets the initial value at connect or accept. Later calls take
+  //! effect on the TCPPeer thread's next loop iteration (within TCP_TICK_MS).
+  void set_nodelay( bool nodelay ) { _nodelay.store( nodelay ); }
+
+  //! Batch writes explicitly, like TCP_CORK: partial segments are held until uncork() or shutdown
+  void cork() { _corked.store( true ); }
+  void uncork() { _corked.store( false ); }
+
   // Return peer address from underlying datagram adapter
   const Address& peer_address() const { return _datagram_adapter.config().destination; }
 
+  //! \name
+  //! Owner-thread reads and writes with DataPath::SPSC (after connect or accept), in place of the fd.
+  //! The bytes go straight into and out of buffers shared with the TCPPeer thread, with no syscall unless
+  //! one side has to wake the other.
+
+  //!@{
+  //! Copy as much of `data` as fits into the outbound stream, waiting until some fits.
+  //! \returns the number of bytes written (0 once the outbound stream has been shut down)
+  size_t write_direct( std::string_view data );
+
+  //! Wait for inbound bytes and move a contiguous run of them into `buffer` (left empty at EOF)
+  void read_direct( std::string& buffer );
+
+  //! Has the inbound stream been read to the end?
+  bool eof_direct() const;
+
+  //! End the outbound stream, like shutdown(SHUT_WR)
+  void shutdown_write_direct();
+  //!@}
+
 protected:
   //! Adapter to underlying datagram socket (e.g., UDP or IP)
   AdaptT _datagram_adapter;
@@ -64,9 +103,23 @@ private:
   //! Stream socket for reads and writes between owner and TCP thread
   LocalStreamSocket _thread_data;
 
+  //! How the owner's bytes reach the TCPPeer thread
+  DataPath _data_path;
+
+  //! With DataPath::SPSC: bytes from the owner to the TCPPeer thread, and back
+  std::optional<SPSCByteStream> _outbound_direct {};
+  std::optional<SPSCByteStream> _inbound_direct {};
+
   //! Set up the TCPPeer and the event loop
   void _initialize_TCP( const TCPConfig& config );
 
+  //! Event loop rules moving bytes between the TCPPeer and the owner (through _thread_data or the SPSC streams)
+  void _add_socketpair_rules();
+  void _add_direct_rules();
+
+  //! Throw unless the SPSC streams are set up (DataPath::SPSC, after connect or accept)
+  void _require_direct() const;
+
   //! TCP state machine
   std::optional<TCPPeer> _tcp {};
 
@@ -76,6 +129,9 @@ private:
   //! Process events while specified condition is true
   void _tcp_loop( const std::function<bool()>& condition );
 
+  //! Apply the owner's set_nodelay(), cork() and uncork() calls on the TCPPeer thread
+  void _apply_socket_options();
+
   //! Main loop of TCPPeer thread
   void _tcp_main();
 
@@ -83,10 +139,16 @@ private:
   std::thread _tcp_thread {};
 
   //! Construct LocalStreamSocket fds from socket pair, initialize eventloop
-  TCPMinnowSocket( std::pair<FileDescriptor, FileDescriptor> data_socket_pair, AdaptT&& datagram_interface );
+  TCPMinnowSocket( std::pair<FileDescriptor, FileDescriptor> data_socket_pair,
+                   AdaptT&& datagram_interface,
+                   DataPath data_path );
 
   std::atomic_bool _abort { false }; //!< Flag used by the owner to force the TCPPeer thread to shut down
 
+  std::atomic_bool _nodelay { true }; //!< Owner's Nagle setting, applied by the TCPPeer thread
+
+  std::atomic_bool _corked { false }; //!< Owner's cork setting, applied by the TCPPeer thread
+
   bool _inbound_shutdown { false }; //!< Has TCPMinnowSocket shut down the incoming data to the owner?
 
   bool _outbound_shutdown { false }; //!< Has the owner shut down the outbound data to the TCP connection?
@@ -116,6 +178,8 @@ using LossyTCPOverIPv4MinnowSocket = TCPMinnowSocket<LossyFdAdapter<TCPOverIPv4O
 //!   and [accept(2)](\ref man2::accept)
 //! - if TCPMinnowSocket is destructed while a TCP connection is open, the connection is
 //!   immediately terminated with a RST (call `wait_until_closed` to avoid this)
+//! - with DataPath::SPSC, the owner moves bytes with read_direct() and write_direct() rather than
+//!   through the socket's fd, saving the two syscalls and two kernel copies of the socketpair hop
 
 //! Helper class that makes a TCPOverIPv4MinnowSocket behave more like a (kernel) TCPSocket
 class CS144TCPSocket : public TCPOverIPv4MinnowSocket
@@ -2,6 +2,7 @@
 
 #include "exception.hh"
 
+#include <algorithm>
 #include <cstddef>
 #include <exception>
 #include <iostream>
@@ -12,6 +13,20 @@
 
 static constexpr size_t TCP_TICK_MS = 10;
 
+//! Fit the TCP configuration to the adapter's link: an MSS whose segments fit in the MTU, and
+//! super-segments of up to gso_segments of them, which the adapter splits on the way out
+inline TCPConfig fit_to_link( TCPConfig c_tcp, const FdAdapterConfig& c_ad )
+{
+  if ( c_ad.mtu.has_value() ) {
+    // An MTU too small to hold the headers would wrap around; a link like that still gets a 1-byte MSS
+    const size_t headers = IPv4Header::LENGTH + TCPSegment::HEADER_LENGTH;
+    const auto link_mss = static_cast<uint16_t>( std::max<size_t>( *c_ad.mtu, headers + 1 ) - headers );
+    c_tcp.mss = std::min( c_tcp.mss.value_or( link_mss ), link_mss );
+    c_tcp.gso_segments = c_ad.gso_segments;
+  }
+  return c_tcp;
+}
+
 inline uint64_t timestamp_ms()
 {
   static_assert( std::is_same_v<std::chrono::steady_clock::duration, std::chrono::nanoseconds> );
@@ -35,6 +50,7 @@ void TCPMinnowSocket<AdaptT>::_tcp_loop( const std::function<bool()>& condition
     }
 
     if ( _tcp.value().active() ) {
+      _apply_socket_options();
       const auto next_time = timestamp_ms();
       _tcp.value().tick( next_time - base_time, [&]( auto x ) { _datagram_adapter.write( x ); } );
       _datagram_adapter.tick( next_time - base_time );
@@ -43,14 +59,35 @@ void TCPMinnowSocket<AdaptT>::_tcp_loop( const std::function<bool()>& condition
   }
 }
 
+//! Hand the owner's Nagle and cork settings to the TCPPeer; uncorking sends whatever was held back
+template<TCPDatagramAdapter AdaptT>
+void TCPMinnowSocket<AdaptT>::_apply_socket_options()
+{
+  const bool nodelay = _nodelay.load();
+  if ( nodelay != _tcp->sender().nodelay() ) {
+    _tcp->set_nodelay( nodelay );
+  }
+  const bool corked = _corked.load();
+  if ( corked != _tcp->sender().corked() ) {
+    if ( corked ) {
+      _tcp->cork();
+    } else {
+      _tcp->uncork( [&]( auto x ) { _datagram_adapter.write( x ); } );
+    }
+  }
+}
+
 //! \param[in] data_socket_pair is a pair of connected AF_UNIX SOCK_STREAM sockets
 //! \param[in] datagram_interface is the interface for reading and writing datagrams
+//! \param[in] data_path says whether the owner's bytes go through the socket pair or the SPSC streams
 template<TCPDatagramAdapter AdaptT>
 TCPMinnowSocket<AdaptT>::TCPMinnowSocket( std::pair<FileDescriptor, FileDescriptor> data_socket_pair,
-                                          AdaptT&& datagram_interface )
+                                          AdaptT&& datagram_interface,
+                                          DataPath data_path )
   : LocalStreamSocket( std::move( data_socket_pair.first ) )
   , _datagram_adapter( std::move( datagram_interface ) )
   , _thread_data( std::move( data_socket_pair.second ) )
+  , _data_path( data_path )
 {
   _thread_data.set_blocking( false );
   set_blocking( false );
@@ -60,20 +97,28 @@ template<TCPDatagramAdapter AdaptT>
 void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
 {
   _tcp.emplace( config );
+  _nodelay.store( not config.nagle );
 
   // Set up the event loop
 
-  // There are three events to handle:
+  // There are five events to handle:
   //
   // 1) Incoming datagram received (needs to be given to TCPPeer::receive method)
   //
   // 2) Outbound bytes received from local application via a write()
-  //    call (needs to be read from the local stream socket and
-  //    given to TCPPeer)
+  //    call (needs to be read from the local stream socket, or the
+  //    outbound SPSC stream, and given to TCPPeer)
   //
   // 3) Incoming bytes reassembled by the Reassembler
   //    (needs to be read from the inbound_stream and written
-  //    to the local stream socket back to the application)
+  //    to the local stream socket, or the inbound SPSC stream,
+  //    back to the application)
+  //
+  // 4) A paced segment is due (the sender is holding data back
+  //    to spread it over the RTT)
+  //
+  // 5) A delayed ack is due (no second segment or outgoing data
+  //    came along to carry it)
 
   // rule 1: read from filtered packet stream and dump into TCPConnection
   _eventloop.add_rule(
@@ -86,7 +131,7 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
       }
 
       // debugging output:
-      if ( _thread_data.eof() and _tcp.value().sender().sequence_numbers_in_flight() == 0 and not _fully_acked ) {
+      if ( _outbound_shutdown and _tcp.value().sender().sequence_numbers_in_flight() == 0 and not _fully_acked ) {
         std::cerr << "DEBUG: minnow outbound stream to " << _datagram_adapter.config().destination.to_string()
                   << " has been fully acknowledged.\n";
         _fully_acked = true;
@@ -94,16 +139,50 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
     },
     [&] { return _tcp->active(); } );
 
+  // rules 2 and 3: move bytes between the TCPPeer and the owner
+  if ( _data_path == DataPath::SPSC ) {
+    _outbound_direct.emplace( config.send_capacity );
+    _inbound_direct.emplace( config.recv_capacity );
+    _add_direct_rules();
+  } else {
+    _add_socketpair_rules();
+  }
+
+  // rule 4: wake up when the next paced segment is due, rather than at the next TCP_TICK_MS poll timeout.
+  // Nothing to do in the callback itself: _tcp_loop ticks the TCPPeer after every event, which releases it.
+  _eventloop.add_timer(
+    _eventloop.add_category( "release paced segments" ),
+    [&]() -> std::optional<uint64_t> {
+      if ( not _tcp->active() ) {
+        return {};
+      }
+      return _tcp->next_send_ms();
+    },
+    [] {} );
+
+  // rule 5: wake up when a delayed ack is due; as with rule 4, the tick after the event sends it.
+  _eventloop.add_timer(
+    _eventloop.add_category( "send delayed ack" ),
+    [&]() -> std::optional<uint64_t> {
+      if ( not _tcp->active() ) {
+        return {};
+      }
+      return _tcp->next_ack_ms();
+    },
+    [] {} );
+}
+
+//! Rules 2 and 3 with DataPath::SocketPair: bytes go through _thread_data
+template<TCPDatagramAdapter AdaptT>
+void TCPMinnowSocket<AdaptT>::_add_socketpair_rules()
+{
   // rule 2: read from pipe into outbound buffer
   _eventloop.add_rule(
     "push bytes to TCPPeer",
     _thread_data,
     Direction::In,
     [&] {
-      std::string data;
-      data.resize( _tcp->outbound_writer().available_capacity() );
-      _thread_data.read( data );
-      _tcp->outbound_writer().push( move( data ) );
+      read_into( _thread_data, _tcp->outbound_writer() );
 
       if ( _thread_data.eof() ) {
         _tcp->outbound_writer().close();
@@ -141,9 +220,9 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
       // Write from the inbound_stream into
       // the pipe, handling the possibility of a partial
       // write (i.e., only pop what was actually written).
+      // All buffered regions go out in a single writev.
       if ( inbound.bytes_buffered() ) {
-        const std::string_view buffer = inbound.peek();
-        const auto bytes_written = _thread_data.write( buffer );
+        const auto bytes_written = _thread_data.write( inbound.peek_regions() );
         inbound.pop( bytes_written );
       }
 
@@ -168,6 +247,74 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
     } );
 }
 
+//! Rules 2 and 3 with DataPath::SPSC: bytes go straight between the TCPPeer's buffers and the SPSC streams.
+//! Each rule polls an eventfd that the owner signals when it makes progress; the rule re-arms it while work is
+//! left, so it stays readable like a socket would.
+template<TCPDatagramAdapter AdaptT>
+void TCPMinnowSocket<AdaptT>::_add_direct_rules()
+{
+  // rule 2: read from outbound SPSC stream into outbound buffer
+  _eventloop.add_rule(
+    "push bytes to TCPPeer",
+    _outbound_direct->readable_fd(),
+    Direction::In,
+    [&] {
+      read_into( *_outbound_direct, _tcp->outbound_writer() );
+
+      if ( _outbound_direct->is_finished() ) {
+        _tcp->outbound_writer().close();
+        _outbound_shutdown = true;
+
+        // debugging output:
+        std::cerr << "DEBUG: minnow outbound stream to " << _datagram_adapter.config().destination.to_string()
+                  << " finished (" << _tcp.value().sender().sequence_numbers_in_flight() << " seqno"
+                  << ( _tcp.value().sender().sequence_numbers_in_flight() == 1 ? "" : "s" )
+                  << " still in flight).\n";
+      }
+      _outbound_direct->rearm_readable();
+
+      _tcp->push( [&]( auto x ) { _datagram_adapter.write( x ); } );
+    },
+    [&] {
+      return ( _tcp->active() ) and ( not _outbound_shutdown )
+             and ( _tcp->outbound_writer().available_capacity() > 0 );
+    } );
+
+  // rule 3: read from inbound buffer into inbound SPSC stream
+  _eventloop.add_rule(
+    "read bytes from inbound stream",
+    _inbound_direct->writable_fd(),
+    Direction::In,
+    [&] {
+      Reader& inbound = _tcp->inbound_reader();
+      while ( inbound.bytes_buffered() ) {
+        const auto bytes_written = _inbound_direct->push( inbound.peek() );
+        if ( bytes_written == 0 ) {
+          break;
+        }
+        inbound.pop( bytes_written );
+      }
+
+      if ( inbound.is_finished() or inbound.has_error() ) {
+        _inbound_direct->close();
+        _inbound_shutdown = true;
+
+        // debugging output:
+        std::cerr << "DEBUG: minnow inbound stream from " << _datagram_adapter.config().destination.to_string()
+                  << " finished " << ( inbound.has_error() ? "uncleanly.\n" : "cleanly.\n" );
+      }
+      _inbound_direct->rearm_writable();
+    },
+    [&] {
+      return _tcp->inbound_reader().bytes_buffered()
+             or ( ( _tcp->inbound_reader().is_finished() or _tcp->inbound_reader().has_error() )
+                  and not _inbound_shutdown );
+    } );
+
+  // The inbound stream starts out with room, so arm its eventfd for rule 3's first bytes
+  _inbound_direct->rearm_writable();
+}
+
 //! \brief Call [socketpair](\ref man2::socketpair) and return connected Unix-domain sockets of specified type
 //! \param[in] type is the type of AF_UNIX sockets to create (e.g., SOCK_SEQPACKET)
 //! \returns a std::pair of connected sockets
@@ -180,10 +327,12 @@ inline std::pair<SocketType, SocketType> socket_pair_helper( int domain, int typ
 }
 
 //! \param[in] datagram_interface is the underlying interface (e.g. to UDP, IP, or Ethernet)
+//! \param[in] data_path says how the owner's bytes reach the TCPPeer thread
 template<TCPDatagramAdapter AdaptT>
-TCPMinnowSocket<AdaptT>::TCPMinnowSocket( AdaptT&& datagram_interface )
+TCPMinnowSocket<AdaptT>::TCPMinnowSocket( AdaptT&& datagram_interface, DataPath data_path )
   : TCPMinnowSocket( socket_pair_helper<LocalStreamSocket>( AF_UNIX, SOCK_STREAM ),
-                     std::move( datagram_interface ) )
+                     std::move( datagram_interface ),
+                     data_path )
 {}
 
 template<TCPDatagramAdapter AdaptT>
@@ -205,6 +354,9 @@ template<TCPDatagramAdapter AdaptT>
 void TCPMinnowSocket<AdaptT>::wait_until_closed()
 {
   shutdown( SHUT_RDWR );
+  if ( _outbound_direct ) {
+    _outbound_direct->close();
+  }
   if ( _tcp_thread.joinable() ) {
     std::cerr << "DEBUG: minnow waiting for clean shutdown... ";
     _tcp_thread.join();
@@ -221,7 +373,7 @@ void TCPMinnowSocket<AdaptT>::connect( const TCPConfig& c_tcp, const FdAdapterCo
     throw std::runtime_error( "connect() with TCPConnection already initialized" );
   }
 
-  _initialize_TCP( c_tcp );
+  _initialize_TCP( fit_to_link( c_tcp, c_ad ) );
 
   _datagram_adapter.config_mut() = c_ad;
 
@@ -256,7 +408,7 @@ void TCPMinnowSocket<AdaptT>::listen_and_accept( const TCPConfig& c_tcp, const F
     throw std::runtime_error( "listen_and_accept() with TCPConnection already initialized" );
   }
 
-  _initialize_TCP( c_tcp );
+  _initialize_TCP( fit_to_link( c_tcp, c_ad ) );
 
   _datagram_adapter.config_mut() = c_ad;
   _datagram_adapter.set_listening( true );
@@ -277,6 +429,11 @@ void TCPMinnowSocket<AdaptT>::_tcp_main()
     }
     _tcp_loop( [] { return true; } );
     shutdown( SHUT_RDWR );
+    if ( _data_path == DataPath::SPSC ) {
+      // wake an owner waiting in read_direct() or write_direct()
+      _inbound_direct->close();
+      _outbound_direct->close();
+    }
     if ( not _tcp.value().active() ) {
       std::cerr << "DEBUG: minnow TCP connection finished "
                 << ( _tcp->inbound_reader().has_error() ? "uncleanly.\n" : "cleanly.\n" );
@@ -287,3 +444,56 @@ void TCPMinnowSocket<AdaptT>::_tcp_main()
     throw e;
   }
 }
+
+template<TCPDatagramAdapter AdaptT>
+void TCPMinnowSocket<AdaptT>::_require_direct() const
+{
+  if ( not _outbound_direct or not _inbound_direct ) {
+    throw std::runtime_error( "direct read or write on a TCPMinnowSocket without DataPath::SPSC, or before "
+                              "connect() or listen_and_accept()" );
+  }
+}
+
+//! \param[in] data is the bytes to send; the return value says how many were taken
+template<TCPDatagramAdapter AdaptT>
+size_t TCPMinnowSocket<AdaptT>::write_direct( std::string_view data )
+{
+  _require_direct();
+  if ( data.empty() ) {
+    return 0;
+  }
+  while ( true ) {
+    const auto bytes_written = _outbound_direct->push( data );
+    if ( bytes_written > 0 or _outbound_direct->is_closed() ) {
+      return bytes_written;
+    }
+    _outbound_direct->wait_writable();
+  }
+}
+
+//! \param[out] buffer receives the bytes, and is empty at EOF
+template<TCPDatagramAdapter AdaptT>
+void TCPMinnowSocket<AdaptT>::read_direct( std::string& buffer )
+{
+  _require_direct();
+  while ( _inbound_direct->bytes_buffered() == 0 and not _inbound_direct->is_closed() ) {
+    _inbound_direct->wait_readable();
+  }
+  const std::string_view view = _inbound_direct->peek();
+  buffer.assign( view );
+  _inbound_direct->pop( view.size() );
+}
+
+template<TCPDatagramAdapter AdaptT>
+bool TCPMinnowSocket<AdaptT>::eof_direct() const
+{
+  _require_direct();
+  return _inbound_direct->is_finished();
+}
+
+template<TCPDatagramAdapter AdaptT>
+void TCPMinnowSocket<AdaptT>::shutdown_write_direct()
+{
+  _require_direct();
+  _outbound_direct->close();
+}
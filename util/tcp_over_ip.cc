@@ -4,6 +4,7 @@
 #include "ipv4_datagram.hh"
 #include "ipv4_header.hh"
 
+#include <algorithm>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <utility>
@@ -85,7 +86,7 @@ InternetDatagram TCPOverIPv4Adapter::wrap_tcp_in_ip( const TCPMessage& msg )
   InternetDatagram ip_dgram;
   ip_dgram.header.src = config().source.ipv4_numeric();
   ip_dgram.header.dst = config().destination.ipv4_numeric();
-  ip_dgram.header.len = ip_dgram.header.hlen * 4 + 20 /* tcp header len */ + payload_size;
+  ip_dgram.header.len = ip_dgram.header.hlen * 4 + seg.header_length() + payload_size;
 
   // set payload, calculating TCP checksum using information from IP header
   seg.compute_checksum( ip_dgram.header.pseudo_checksum() );
@@ -94,3 +95,47 @@ InternetDatagram TCPOverIPv4Adapter::wrap_tcp_in_ip( const TCPMessage& msg )
 
   return ip_dgram;
 }
+
+//! \details If the message fits in one datagram (or no MTU is configured) and carries no more payload than
+//! its gso_size, the result is the message itself. Otherwise the payload is cut into pieces that each fit in
+//! one datagram, with the options the piece carries taken into account, and hold at most gso_size bytes.
+//! SYN and its options stay on the first piece, FIN goes on the last, and every piece carries the same
+//! acknowledgment.
+vector<TCPMessage> TCPOverIPv4Adapter::split_to_mtu( const TCPMessage& msg ) const
+{
+  const TCPSenderMessage& whole = msg.sender.get();
+  const auto tcp_length = [&]( const TCPSenderMessage& piece ) {
+    const TCPSegment seg { .message = { Ref<TCPSenderMessage>::borrow( piece ), msg.receiver.borrow() } };
+    return seg.header_length() + piece.payload.size();
+  };
+  const size_t segment_size = whole.gso_size.value_or( whole.payload.size() );
+  const bool fits_mtu
+    = not config().mtu.has_value() or IPv4Header::LENGTH + tcp_length( whole ) <= *config().mtu;
+  if ( fits_mtu and whole.payload.size() <= segment_size ) {
+    return { { msg.sender.borrow(), msg.receiver.borrow() } };
+  }
+
+  vector<TCPMessage> pieces;
+  size_t offset = 0;
+  while ( offset < whole.payload.size() or pieces.empty() ) {
+    TCPSenderMessage piece { .seqno = whole.seqno + static_cast<uint32_t>( offset + ( offset > 0 and whole.SYN ) ),
+                             .SYN = offset == 0 and whole.SYN,
+                             .RST = whole.RST,
+                             .timestamp = whole.timestamp };
+    if ( piece.SYN ) {
+      piece.sack_permitted = whole.sack_permitted;
+      piece.window_scale = whole.window_scale;
+      piece.mss = whole.mss;
+    }
+    size_t room = max<size_t>( segment_size, 1 );
+    if ( config().mtu.has_value() ) {
+      const size_t overhead = IPv4Header::LENGTH + tcp_length( piece );
+      room = min( room, *config().mtu > overhead ? *config().mtu - overhead : 1 );
+    }
+    piece.payload = whole.payload.substr( offset, room );
+    offset += piece.payload.size();
+    piece.FIN = offset == whole.payload.size() and whole.FIN;
+    pieces.push_back( { move( piece ), msg.receiver.borrow() } );
+  }
+  return pieces;
+}
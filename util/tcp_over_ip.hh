@@ -5,6 +5,7 @@
 #include "tcp_segment.hh"
 
 #include <optional>
+#include <vector>
 
 //! \brief A converter from TCP segments to serialized IPv4 datagrams
 class TCPOverIPv4Adapter : public FdAdapterBase
@@ -13,4 +14,7 @@ public:
   std::optional<TCPMessage> unwrap_tcp_in_ip( InternetDatagram ip_dgram );
 
   InternetDatagram wrap_tcp_in_ip( const TCPMessage& msg );
+
+  //! Split a message whose datagram would exceed the configured MTU into several that fit (GSO)
+  std::vector<TCPMessage> split_to_mtu( const TCPMessage& msg ) const;
 };
@@ -1,14 +1,18 @@
 #pragma once
 
 #include "tcp_config.hh"
+#include "tcp_receive_memory.hh"
 #include "tcp_receiver.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_segment.hh"
 #include "tcp_sender.hh"
 #include "tcp_sender_message.hh"
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <optional>
+#include <utility>
 
 class TCPPeer
 {
@@ -32,9 +36,36 @@ public:
   {
     cumulative_time_ += t;
     sender_.tick( t, make_send( transmit ) );
+    if ( cfg_.recv_autotune ) {
+      autotune_receive_buffer();
+    }
+    if ( ack_deadline_.has_value() and cumulative_time_ >= *ack_deadline_ ) {
+      send( sender_.make_empty_message(), transmit );
+    }
   }
   bool has_ackno() const { return receiver_.send().ackno.has_value(); }
 
+  /* Nagle's algorithm and corking (see TCPSender); uncorking sends whatever was held back */
+  void set_nodelay( bool nodelay ) { sender_.set_nodelay( nodelay ); }
+  void cork() { sender_.cork(); }
+  void uncork( const TransmitFunction& transmit )
+  {
+    sender_.uncork();
+    push( transmit );
+  }
+
+  /* Milliseconds until the sender's pacing lets a held-back segment out, if it is holding one */
+  std::optional<uint64_t> next_send_ms() const { return sender_.next_send_ms(); }
+
+  /* Milliseconds until a delayed ack is due, if one is waiting */
+  std::optional<uint64_t> next_ack_ms() const
+  {
+    if ( not ack_deadline_.has_value() ) {
+      return {};
+    }
+    return *ack_deadline_ > cumulative_time_ ? *ack_deadline_ - cumulative_time_ : 0;
+  }
+
   /* Is the peer still active? */
   bool active() const
   {
@@ -56,19 +87,57 @@ public:
     // Record time in case this peer has to linger after streams finish.
     time_of_last_receipt_ = cumulative_time_;
 
-    // If SenderMessage occupies a sequence number, make sure to reply.
-    need_send_ |= ( msg.sender->sequence_length() > 0 );
-
     // If SenderMessage is a "keep-alive" (with intentionally invalid seqno), make sure to reply.
     // (N.B. orthodox TCP rules require a reply on any unacceptable segment.)
     const auto our_ackno = receiver_.send().ackno;
     need_send_ |= ( our_ackno.has_value() and msg.sender->seqno + 1 == our_ackno.value() );
 
-    // Give incoming TCPSenderMessage to receiver.
-    receiver_.receive( std::move( msg.sender ) );
+    // Note what the SenderMessage covers before the receiver takes it.
+    const uint64_t sequence_length = msg.sender->sequence_length();
+    const Wrap32 end_of_segment = msg.sender->seqno + static_cast<uint32_t>( sequence_length );
+    const bool in_order_data = our_ackno == msg.sender->seqno and not msg.sender->FIN;
+
+    // Give incoming TCPSenderMessage to receiver (moving the payload out if we own it).
+    const bool had_syn = has_ackno();
+    receiver_.receive( msg.sender.release() );
+
+    // If SenderMessage occupies a sequence number, make sure to reply. With delayed acks, in-order data that
+    // advanced the ackno by exactly itself may wait for a second segment, outgoing data or the ack timer.
+    // Anything else (SYN, FIN, out of order, or filling a gap) is acked at once, so the peer's fast
+    // retransmit still sees duplicate acks.
+    if ( sequence_length > 0 ) {
+      const bool may_delay
+        = cfg_.delayed_ack and in_order_data and receiver_.send().ackno == end_of_segment and not ack_deadline_;
+      if ( may_delay ) {
+        ack_deadline_ = cumulative_time_ + cfg_.ack_delay;
+      } else {
+        need_send_ = true;
+      }
+    }
 
-    // Give incoming TCPReceiverMessage to sender.
-    sender_.receive( msg.receiver );
+    // Once both SYNs carried the timestamp option, stamp every segment. This comes before the sender sees the
+    // ack, so the echo on the peer's SYN already yields an RTT sample.
+    if ( receiver_.timestamps_negotiated() ) {
+      sender_.enable_timestamps();
+    }
+
+    // Give incoming TCPReceiverMessage to sender. An ack riding on data, SYN or FIN is never a duplicate ack
+    // (RFC 5681). The window on a SYN is never scaled, so the peer's window scale (if both sides offered one)
+    // only applies from the next segment on.
+    sender_.receive( msg.receiver, sequence_length > 0 );
+    if ( const auto shift = receiver_.peer_window_scale() ) {
+      sender_.set_window_scale( *shift );
+    }
+
+    // Once the peer's SYN is in, never send segments larger than the MSS it advertised (RFC 9293). If it sent
+    // none, assume the default MSS only if we negotiate one ourselves; otherwise keep the configured size.
+    if ( not had_syn and has_ackno() ) {
+      if ( const auto peer_mss = receiver_.peer_mss() ) {
+        sender_.set_peer_mss( *peer_mss );
+      } else if ( cfg_.mss.has_value() ) {
+        sender_.set_peer_mss( TCPConfig::DEFAULT_MSS );
+      }
+    }
 
     // Send reply if needed.
     push( transmit );
@@ -76,8 +145,9 @@ public:
       send( sender_.make_empty_message(), transmit );
     }
 
-    // Did the inbound stream finish before the outbound stream? If so, no need to linger after streams finish.
-    if ( receiver_.writer().is_closed() and not std::as_const( sender_ ).reader().is_finished() ) {
+    // Did the inbound stream finish before we sent our FIN? If so, no need to linger after streams finish.
+    // (Not the outbound stream finishing: that waits for the peer to ack every byte.)
+    if ( receiver_.writer().is_closed() and not sender_.fin_sent() ) {
       linger_after_streams_finish_ = false;
     }
   }
@@ -85,20 +155,71 @@ public:
   // Testing interface
   const TCPReceiver& receiver() const { return receiver_; }
   const TCPSender& sender() const { return sender_; }
+  const TCPReceiveMemory& receive_memory() const { return receive_memory_; } // autotuned growth of the buffer
 
 private:
   TCPConfig cfg_;
-  TCPSender sender_ { ByteStream { cfg_.send_capacity }, cfg_.isn, cfg_.rt_timeout };
-  TCPReceiver receiver_ { Reassembler { ByteStream { cfg_.recv_capacity } } };
+  TCPSender sender_ { ByteStream { cfg_.send_capacity, ByteStream::Storage::Ring }, cfg_ };
+  TCPReceiver receiver_ { Reassembler { ByteStream { cfg_.recv_capacity, ByteStream::Storage::Chunked } },
+                         cfg_.sack,
+                         cfg_.window_scale(),
+                         cfg_.timestamps };
 
   bool need_send_ {};
+  std::optional<uint64_t> ack_deadline_ {}; // when the delayed ack for one unacked segment is due
 
   void send( const TCPSenderMessage& sender_message, const TransmitFunction& transmit )
   {
-    transmit( { borrow( sender_message ), receiver_.send() } );
+    TCPReceiverMessage receiver_message = receiver_.send();
+    if ( sender_message.SYN ) {
+      // RFC 7323: the window in a SYN segment is never scaled
+      receiver_message.window_size
+        = static_cast<uint16_t>( std::min<uint64_t>( receiver_.writer().available_capacity(), UINT16_MAX ) );
+    }
+    if ( receiver_message.ackno.has_value() ) {
+      receiver_.ack_sent( *receiver_message.ackno ); // Last.ACK.sent, for updating the timestamp to echo
+    }
+    transmit( { borrow( sender_message ), std::move( receiver_message ) } );
     need_send_ = false;
+    ack_deadline_.reset(); // every segment carries the latest ackno
+  }
+
+  // Receive-buffer autotuning, like Linux's tcp_rcv_space_adjust: once per RTT, if the application drained more
+  // than half the buffer, grow it to twice what was drained (room for the sender's window to keep doubling),
+  // up to recv_capacity_max and whatever the process-wide pool can still grant.
+  void autotune_receive_buffer()
+  {
+    const uint64_t rtt = sender_.srtt_ms();
+    if ( rtt == 0 or cumulative_time_ < autotune_time_ + rtt ) {
+      return;
+    }
+    const uint64_t popped = receiver_.reader().bytes_popped();
+    const uint64_t drained = popped - autotune_popped_;
+    autotune_time_ = cumulative_time_;
+    autotune_popped_ = popped;
+
+    // If the drain rate grew since the last round, the sender is likely still in slow start: leave room for
+    // it to keep growing at that pace for another round.
+    uint64_t wanted = 2 * drained;
+    if ( autotune_drained_ > 0 and drained > autotune_drained_ ) {
+      wanted += 2 * wanted * ( drained - autotune_drained_ ) / autotune_drained_;
+    }
+    autotune_drained_ = drained;
+
+    const uint64_t capacity = receiver_.writer().available_capacity() + receiver_.reader().bytes_buffered();
+    const uint64_t target = std::min<uint64_t>( wanted, cfg_.recv_capacity_max );
+    if ( target > capacity ) {
+      if ( const uint64_t granted = receive_memory_.reserve( target - capacity ) ) {
+        receiver_.grow_capacity( capacity + granted );
+      }
+    }
   }
 
+  TCPReceiveMemory receive_memory_ {};
+  uint64_t autotune_time_ {};    // start of the current autotuning round
+  uint64_t autotune_popped_ {};  // bytes the application had read at that point
+  uint64_t autotune_drained_ {}; // bytes the application read in the last round
+
   bool linger_after_streams_finish_ { true }; // one peer may need to linger to make sure all closure conditions met
   uint64_t cumulative_time_ {};
   uint64_t time_of_last_receipt_ {};
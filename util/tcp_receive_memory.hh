@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+//! Receive-buffer memory that autotuning may grow into, shared by every TCPPeer in the process (like Linux's
+//! tcp_mem). Each object holds one connection's reservation and returns it to the pool when destroyed.
+//! Only growth beyond a connection's initial recv_capacity is counted.
+class TCPReceiveMemory
+{
+public:
+  static constexpr uint64_t DEFAULT_LIMIT = 64 * 1024 * 1024; //!< Default process-wide limit, in bytes
+
+  static void set_limit( uint64_t bytes ) { limit_.store( bytes ); } //!< Change the process-wide limit
+  static uint64_t limit() { return limit_.load(); }                  //!< Process-wide limit, in bytes
+  static uint64_t in_use() { return in_use_.load(); }                //!< Bytes reserved by all connections
+
+  TCPReceiveMemory() = default;
+  ~TCPReceiveMemory() { release(); }
+  TCPReceiveMemory( const TCPReceiveMemory& ) = delete;
+  TCPReceiveMemory& operator=( const TCPReceiveMemory& ) = delete;
+  TCPReceiveMemory( TCPReceiveMemory&& other ) noexcept : reserved_( std::exchange( other.reserved_, 0 ) ) {}
+  TCPReceiveMemory& operator=( TCPReceiveMemory&& other ) noexcept
+  {
+    release();
+    reserved_ = std::exchange( other.reserved_, 0 );
+    return *this;
+  }
+
+  //! Reserve up to `bytes` more for this connection; returns how many the pool could grant
+  uint64_t reserve( uint64_t bytes )
+  {
+    uint64_t used = in_use_.load();
+    uint64_t granted {};
+    do {
+      const uint64_t lim = limit_.load();
+      granted = used >= lim ? 0 : std::min( bytes, lim - used );
+    } while ( granted > 0 and not in_use_.compare_exchange_weak( used, used + granted ) );
+    reserved_ += granted;
+    return granted;
+  }
+
+  uint64_t reserved() const { return reserved_; } //!< Bytes held by this connection
+
+private:
+  void release()
+  {
+    in_use_ -= reserved_;
+    reserved_ = 0;
+  }
+
+  static inline std::atomic<uint64_t> limit_ { DEFAULT_LIMIT };
+  static inline std::atomic<uint64_t> in_use_ {};
+  uint64_t reserved_ {};
+};
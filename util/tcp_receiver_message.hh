@@ -2,26 +2,51 @@
 
 #include "wrapping_integers.hh"
 
+#include <cstddef>
 #include <optional>
+#include <vector>
 
 /*
  * The TCPReceiverMessage structure contains the information sent from a TCP receiver to its sender.
  *
- * It contains three fields:
+ * It contains five fields:
  *
  * 1) The acknowledgment number (ackno): the *next* sequence number needed by the TCP Receiver.
  *    This is an optional field that is empty if the TCPReceiver hasn't yet received the Initial Sequence Number.
  *
  * 2) The window size. This is the number of sequence numbers that the TCP receiver is interested
  *    to receive, starting from the ackno if present. The maximum value is 65,535 (UINT16_MAX from
- *    the <cstdint> header).
+ *    the <cstdint> header). Once window scaling has been negotiated (RFC 7323), the value is in
+ *    units of 2^shift, where shift is the window scale option from the receiver's SYN.
  *
  * 3) The RST (reset) flag. If set, the stream has suffered an error and the connection should be aborted.
+ *
+ * 4) Selective acknowledgments (RFC 2018): ranges of sequence numbers beyond the ackno that the receiver
+ *    already holds. Only sent if the peer's SYN said it understands them, and at most MAX_SACK_BLOCKS
+ *    (MAX_SACK_BLOCKS_WITH_TIMESTAMPS if the segment also carries a timestamp). When serialized, blocks
+ *    that don't fit in the 40 bytes left over by the segment's other options are dropped from the end.
+ *
+ * 5) The timestamp echo (TSecr, RFC 7323): the TSval of the peer's segment this receiver most recently
+ *    accepted at the left edge of its window. Sent in the same option as the segment's own TSval.
  */
 
+// One SACK block: the sequence numbers [begin, end) have been received
+struct SackBlock
+{
+  Wrap32 begin { 0 };
+  Wrap32 end { 0 };
+
+  bool operator==( const SackBlock& other ) const = default;
+};
+
 struct TCPReceiverMessage
 {
   std::optional<Wrap32> ackno {};
   uint16_t window_size {};
   bool RST {};
+  std::vector<SackBlock> sack {};
+  std::optional<uint32_t> timestamp_echo {};
+
+  static constexpr size_t MAX_SACK_BLOCKS = 4; // 2 + 4 * 8 bytes: as many as fit in 40 bytes of TCP options
+  static constexpr size_t MAX_SACK_BLOCKS_WITH_TIMESTAMPS = 3; // the timestamp option takes 12 of the 40 bytes
 };
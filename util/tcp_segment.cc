@@ -3,12 +3,128 @@
 #include "helpers.hh"
 #include "wrapping_integers.hh"
 
+#include <algorithm>
 #include <sstream>
 
 using namespace std;
 
 static_assert( !( TCPSegment::HEADER_LENGTH & 0x03 ) ); // header length must be divisible by 4
 
+namespace {
+
+// TCP option kinds (RFC 9293, RFC 7323 and RFC 2018)
+constexpr uint8_t OPTION_END = 0;
+constexpr uint8_t OPTION_NOP = 1;
+constexpr uint8_t OPTION_MSS = 2;
+constexpr uint8_t OPTION_WINDOW_SCALE = 3;
+constexpr uint8_t OPTION_SACK_PERMITTED = 4;
+constexpr uint8_t OPTION_SACK = 5;
+constexpr uint8_t OPTION_TIMESTAMPS = 8;
+
+constexpr size_t MAX_OPTIONS_LENGTH = 40; // the 4-bit data offset caps the header at 60 bytes
+
+// Bytes taken by every option we send except SACK (all padded to a multiple of 4)
+size_t fixed_options_length( const TCPMessage& msg )
+{
+  size_t length = 0;
+  if ( msg.sender->SYN and msg.sender->mss.has_value() ) {
+    length += 4; // MSS
+  }
+  if ( msg.sender->SYN and msg.sender->window_scale.has_value() ) {
+    length += 4; // NOP, window scale
+  }
+  if ( msg.sender->SYN and msg.sender->sack_permitted ) {
+    length += 4; // NOP, NOP, SACK-permitted
+  }
+  if ( msg.sender->timestamp.has_value() ) {
+    length += 12; // NOP, NOP, timestamps header, TSval, TSecr
+  }
+  return length;
+}
+
+// SACK blocks that fit in the option space the other options leave over
+size_t sack_blocks_sent( const TCPMessage& msg )
+{
+  if ( not msg.receiver->ackno.has_value() or msg.receiver->sack.empty() ) {
+    return 0;
+  }
+  const size_t room = MAX_OPTIONS_LENGTH - fixed_options_length( msg );
+  if ( room < 4 + 8 ) {
+    return 0;
+  }
+  return min( msg.receiver->sack.size(), ( room - 4 ) / 8 ); // NOP, NOP, SACK header, then 8 bytes per block
+}
+
+// Parse `length` bytes of options, skipping any we don't understand
+void parse_options( Parser& parser, uint64_t length, TCPMessage& message )
+{
+  while ( length > 0 and not parser.has_error() ) {
+    uint8_t kind {};
+    parser.integer( kind );
+    length--;
+    if ( kind == OPTION_END ) {
+      break;
+    }
+    if ( kind == OPTION_NOP ) {
+      continue;
+    }
+
+    uint8_t size {};
+    parser.integer( size );
+    if ( length == 0 or size < 2 or size - 1U > length ) {
+      parser.set_error();
+      return;
+    }
+    length -= size - 1;
+    const uint8_t body = size - 2;
+
+    if ( kind == OPTION_MSS and body == 2 ) {
+      uint16_t mss {};
+      parser.integer( mss );
+      message.sender->mss = mss;
+    } else if ( kind == OPTION_WINDOW_SCALE and body == 1 ) {
+      uint8_t shift {};
+      parser.integer( shift );
+      message.sender->window_scale = shift;
+    } else if ( kind == OPTION_SACK_PERMITTED and body == 0 ) {
+      message.sender->sack_permitted = true;
+    } else if ( kind == OPTION_SACK and body % 8 == 0 ) {
+      for ( uint8_t i = 0; i < body / 8; i++ ) {
+        uint32_t begin {};
+        uint32_t end {};
+        parser.integer( begin );
+        parser.integer( end );
+        message.receiver->sack.push_back( { Wrap32 { begin }, Wrap32 { end } } );
+      }
+    } else if ( kind == OPTION_TIMESTAMPS and body == 8 ) {
+      uint32_t value {};
+      uint32_t echo {};
+      parser.integer( value );
+      parser.integer( echo );
+      message.sender->timestamp = value;
+      if ( message.receiver->ackno.has_value() ) {
+        message.receiver->timestamp_echo = echo; // only meaningful with ACK (RFC 7323)
+      }
+    } else {
+      parser.remove_prefix( body );
+    }
+  }
+  if ( not parser.has_error() ) {
+    parser.remove_prefix( length ); // padding after the end-of-options marker
+  }
+}
+
+} // namespace
+
+uint8_t TCPSegment::header_length() const
+{
+  size_t length = HEADER_LENGTH + fixed_options_length( message );
+  if ( const size_t blocks = sack_blocks_sent( message ) ) {
+    length += 4 + 8 * blocks; // NOP, NOP, SACK header, blocks
+  }
+  return static_cast<uint8_t>( length );
+}
+
 void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum )
 {
   /* verify checksum */
@@ -48,12 +164,11 @@ void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum
   parser.integer( udinfo.cksum );
   parser.integer( raw16 ); // urgent pointer
 
-  // skip any options or anything extra in the header
   if ( data_offset < ( HEADER_LENGTH >> 2 ) ) {
     parser.set_error();
     return;
   }
-  parser.remove_prefix( data_offset * 4 - HEADER_LENGTH );
+  parse_options( parser, data_offset * 4 - HEADER_LENGTH, message );
 
   parser.concatenate_all_remaining( message.sender->payload );
 }
@@ -70,7 +185,7 @@ void TCPSegment::serialize( Serializer& serializer ) const
   serializer.integer( udinfo.dst_port );
   serializer.integer( Wrap32Serializable { message.sender->seqno }.raw_value() );
   serializer.integer( Wrap32Serializable { message.receiver->ackno.value_or( Wrap32 { 0 } ) }.raw_value() );
-  serializer.integer( uint8_t { ( HEADER_LENGTH >> 2 ) << 4 } ); // data offset
+  serializer.integer( static_cast<uint8_t>( ( header_length() >> 2 ) << 4 ) ); // data offset
   const bool reset = message.sender->RST or message.receiver->RST;
   const uint8_t flags = ( message.receiver->ackno.has_value() ? 0b0001'0000U : 0 ) | ( reset ? 0b0000'0100U : 0 )
                         | ( message.sender->SYN ? 0b0000'0010U : 0 ) | ( message.sender->FIN ? 0b0000'0001U : 0 );
@@ -78,6 +193,40 @@ void TCPSegment::serialize( Serializer& serializer ) const
   serializer.integer( message.receiver->window_size );
   serializer.integer( udinfo.cksum );
   serializer.integer( uint16_t { 0 } ); // urgent pointer
+
+  // options, each padded with NOPs to a 4-byte boundary
+  if ( message.sender->SYN and message.sender->mss.has_value() ) {
+    serializer.integer( OPTION_MSS );
+    serializer.integer( uint8_t { 4 } );
+    serializer.integer( *message.sender->mss );
+  }
+  if ( message.sender->SYN and message.sender->window_scale.has_value() ) {
+    for ( const uint8_t octet : { OPTION_NOP, OPTION_WINDOW_SCALE, uint8_t { 3 }, *message.sender->window_scale } ) {
+      serializer.integer( octet );
+    }
+  }
+  if ( message.sender->SYN and message.sender->sack_permitted ) {
+    for ( const uint8_t octet : { OPTION_NOP, OPTION_NOP, OPTION_SACK_PERMITTED, uint8_t { 2 } } ) {
+      serializer.integer( octet );
+    }
+  }
+  if ( message.sender->timestamp.has_value() ) {
+    for ( const uint8_t octet : { OPTION_NOP, OPTION_NOP, OPTION_TIMESTAMPS, uint8_t { 10 } } ) {
+      serializer.integer( octet );
+    }
+    serializer.integer( *message.sender->timestamp );
+    serializer.integer( message.receiver->timestamp_echo.value_or( 0 ) );
+  }
+  if ( const size_t blocks = sack_blocks_sent( message ) ) {
+    for ( const uint8_t octet : { OPTION_NOP, OPTION_NOP, OPTION_SACK, static_cast<uint8_t>( 2 + 8 * blocks ) } ) {
+      serializer.integer( octet );
+    }
+    for ( size_t i = 0; i < blocks; i++ ) {
+      serializer.integer( Wrap32Serializable { message.receiver->sack[i].begin }.raw_value() );
+      serializer.integer( Wrap32Serializable { message.receiver->sack[i].end }.raw_value() );
+    }
+  }
+
   serializer.buffer( message.sender->payload );
 }
 
@@ -99,6 +248,15 @@ string TCPSegment::to_string() const
   ss << " seqno=" << Wrap32Serializable { message.sender->seqno }.raw_value();
   if ( message.sender->SYN ) {
     ss << " +SYN";
+    if ( message.sender->mss.has_value() ) {
+      ss << " mss=" << *message.sender->mss;
+    }
+    if ( message.sender->sack_permitted ) {
+      ss << " +SACK_PERM";
+    }
+    if ( message.sender->window_scale.has_value() ) {
+      ss << " wscale=" << static_cast<int>( *message.sender->window_scale );
+    }
   }
   if ( not message.sender->payload.empty() ) {
     ss << " payload=\"" << pretty_print( message.sender->payload ) << "\"";
@@ -113,6 +271,13 @@ string TCPSegment::to_string() const
   if ( ackno.has_value() ) {
     ss << " ACK<" << Wrap32Serializable { *ackno }.raw_value() << ">";
   }
+  for ( const auto& block : message.receiver->sack ) {
+    ss << " SACK<" << Wrap32Serializable { block.begin }.raw_value() << "-"
+       << Wrap32Serializable { block.end }.raw_value() << ">";
+  }
+  if ( message.sender->timestamp.has_value() ) {
+    ss << " TS<" << *message.sender->timestamp << "," << message.receiver->timestamp_echo.value_or( 0 ) << ">";
+  }
   ss << " winsize=" << message.receiver->window_size;
   ss << " src=" << udinfo.src_port << " dst=" << udinfo.dst_port;
   return ss.str();
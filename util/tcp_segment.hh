@@ -29,6 +29,9 @@ struct TCPSegment
 
   static constexpr uint8_t HEADER_LENGTH = 20; // TCP header length, not including options
 
+  // TCP header length including the options this segment carries (a multiple of 4)
+  uint8_t header_length() const;
+
   // Return a string containing a summary in human-readable format
   std::string to_string() const;
 };
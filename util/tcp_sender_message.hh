@@ -2,12 +2,14 @@
 
 #include "wrapping_integers.hh"
 
+#include <cstdint>
+#include <optional>
 #include <string>
 
 /*
  * The TCPSenderMessage structure contains the information sent from a TCP sender to its receiver.
  *
- * It contains five fields:
+ * It contains ten fields:
  *
  * 1) The sequence number (seqno) of the beginning of the segment. If the SYN flag is set, this is the
  *    sequence number of the SYN flag. Otherwise, it's the sequence number of the beginning of the payload.
@@ -20,6 +22,22 @@
  * 4) The FIN flag. If set, the payload represents the ending of the byte stream.
  *
  * 5) The RST (reset) flag. If set, the stream has suffered an error and the connection should be aborted.
+ *
+ * 6) The SACK-permitted option (only meaningful with SYN): the sender understands selective acknowledgments,
+ *    so the peer's receiver may send them.
+ *
+ * 7) The window scale option (only meaningful with SYN): the shift this side will apply to the windows it
+ *    advertises. Scaling is in effect only if both SYNs carry the option.
+ *
+ * 8) The maximum segment size option (only meaningful with SYN): the largest payload this side is willing
+ *    to receive in one segment.
+ *
+ * 9) The timestamp option's TSval (RFC 7323): the sender's clock when the segment was sent. On a SYN it offers
+ *    the option; once both SYNs carried it, every segment does, and the peer echoes it back (see
+ *    TCPReceiverMessage) for RTT measurement and protection against wrapped sequence numbers (PAWS).
+ *
+ * 10) The GSO segment size (not sent on the wire): set on a message carrying more payload than one segment
+ *     may, it is the largest payload of each segment the adapter must cut the message into.
  */
 
 struct TCPSenderMessage
@@ -34,6 +52,16 @@ struct TCPSenderMessage
   bool RST {}; // 表示 TCP 报文段中的 RST
                // 标志。RST（reset）用于异常中断一个连接，比如在出现错误或非法请求时，可以立即中断连接。
 
+  bool sack_permitted {}; // SYN 上的 SACK-permitted 选项：对端的接收方可以给我们发 SACK
+
+  std::optional<uint8_t> window_scale {}; // SYN 上的窗口扩大选项：之后本端通告的窗口要左移这么多位
+
+  std::optional<uint16_t> mss {}; // SYN 上的 MSS 选项：本端一个段最多能收多少字节负载
+
+  std::optional<uint32_t> timestamp {}; // 时间戳选项的 TSval：发出时本端的毫秒时钟
+
+  std::optional<uint16_t> gso_size {}; // 不上线路：超级段要被适配器切成每段最多这么多字节负载
+
   // How many sequence numbers does this segment use?
   size_t sequence_length() const { return SYN + payload.size() + FIN; }
 };
@@ -19,7 +19,9 @@ optional<TCPMessage> TCPOverIPv4OverTunFdAdapter::read()
 
 void TCPOverIPv4OverTunFdAdapter::write( const TCPMessage& seg )
 {
-  _tun.write( serialize( wrap_tcp_in_ip( seg ) ) );
+  for ( const auto& piece : split_to_mtu( seg ) ) {
+    _tun.write( serialize( wrap_tcp_in_ip( piece ) ) );
+  }
 }
 
 //! Specialize LossyFdAdapter to TCPOverIPv4OverTunFdAdapter